@@ -19,8 +19,9 @@ class JSEventListener final : public JSBasedEventListener {
   using ImplType = std::shared_ptr<JSEventListener>;
 
   // TODO: Support IDL EventListener callbackInterface.
-  static std::unique_ptr<JSEventListener> CreateOrNull(std::shared_ptr<QJSFunction> listener) {
-    return listener ? std::make_unique<JSEventListener>(listener) : nullptr;
+  // Allocate the listener together with its reference count, it is shared by every registration of the callback.
+  static std::shared_ptr<JSEventListener> CreateOrNull(std::shared_ptr<QJSFunction> listener) {
+    return listener ? std::make_shared<JSEventListener>(std::move(listener)) : nullptr;
   }
 
   explicit JSEventListener(std::shared_ptr<QJSFunction> listener);
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_string_cache.h"
+
+#if WIN32
+#include <Windows.h>
+#endif
+
+namespace mercury {
+
+// The characters are allocated by JS_ToUnicode, release them with the same allocator before the container.
+static void FreeCachedNativeString(const SharedNativeString* native_string) {
+#if WIN32
+  CoTaskMemFree((LPVOID)native_string->string());
+#else
+  free((void*)native_string->string());
+#endif
+  delete native_string;
+}
+
+NativeStringCache::~NativeStringCache() {
+  for (auto& entry : entries_) {
+    JS_FreeAtomRT(runtime_, entry.first);
+  }
+}
+
+CachedNativeString NativeStringCache::Get(JSContext* ctx, const AtomicString& string) {
+  auto it = entries_.find(string.Impl());
+  if (it != entries_.end())
+    return it->second;
+
+  runtime_ = JS_GetRuntime(ctx);
+  if (entries_.size() >= kMaxEntries) {
+    Evict();
+  }
+
+  CachedNativeString cached{string.ToNativeString(ctx).release(), FreeCachedNativeString};
+  entries_.emplace(JS_DupAtomRT(runtime_, string.Impl()), cached);
+  return cached;
+}
+
+void NativeStringCache::Evict() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.use_count() == 1) {
+      JS_FreeAtomRT(runtime_, it->first);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace mercury
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_BINDINGS_QJS_NATIVE_STRING_CACHE_H_
+#define BRIDGE_BINDINGS_QJS_NATIVE_STRING_CACHE_H_
+
+#include <quickjs/quickjs.h>
+#include <memory>
+#include <unordered_map>
+#include "atomic_string.h"
+#include "foundation/native_string.h"
+
+namespace mercury {
+
+// Immutable UTF-16 encoding of an atom, shared by the cache and its borrowers. The characters are freed when the last
+// reference is dropped, so the dart side must never free a borrowed string.
+using CachedNativeString = std::shared_ptr<const SharedNativeString>;
+
+// Runtime scoped cache of the UTF-16 encodings of hot atoms, such as event types, class names and method names.
+// Encodings are transcoded once and then borrowed by bridge commands and synchronous calls to dart.
+class NativeStringCache {
+ public:
+  NativeStringCache() = default;
+  ~NativeStringCache();
+
+  // Return the shared encoding of the string, hold the returned reference as long as the characters are used.
+  CachedNativeString Get(JSContext* ctx, const AtomicString& string);
+  size_t size() const { return entries_.size(); }
+
+ private:
+  // Drop the entries no one else is borrowing, once the cache grows beyond this size.
+  static constexpr size_t kMaxEntries = 1024;
+  void Evict();
+
+  JSRuntime* runtime_{nullptr};
+  // Keys hold a reference of the atom, so the id is not reused by another string while cached.
+  std::unordered_map<JSAtom, CachedNativeString> entries_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_BINDINGS_QJS_NATIVE_STRING_CACHE_H_
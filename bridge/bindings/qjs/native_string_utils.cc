@@ -6,6 +6,10 @@
 #include "native_string_utils.h"
 #include "bindings/qjs/qjs_engine_patch.h"
 
+#if WIN32
+#include <Windows.h>
+#endif
+
 namespace mercury {
 
 std::unique_ptr<SharedNativeString> jsValueToNativeString(JSContext* ctx, JSValue value) {
@@ -29,16 +33,25 @@ std::unique_ptr<SharedNativeString> jsValueToNativeString(JSContext* ctx, JSValu
 }
 
 std::unique_ptr<SharedNativeString> stringToNativeString(const std::string& string) {
-  std::u16string utf16;
-  fromUTF8(string, utf16);
-  SharedNativeString tmp{reinterpret_cast<const uint16_t*>(utf16.c_str()), static_cast<uint32_t>(utf16.size())};
-  return SharedNativeString::FromTemporaryString(tmp.string(), tmp.length());
+  // Transcode into the buffer owned by the result, the count of bytes is the upper bound of code units.
+#if WIN32
+  auto* buffer = static_cast<uint16_t*>(CoTaskMemAlloc(string.size() * sizeof(uint16_t)));
+#else
+  auto* buffer = static_cast<uint16_t*>(malloc(string.size() * sizeof(uint16_t)));
+#endif
+  size_t length = ConvertUTF8ToUTF16(string.data(), string.size(), buffer);
+  return std::make_unique<SharedNativeString>(buffer, length);
 }
 
 std::string nativeStringToStdString(const SharedNativeString* native_string) {
-  std::u16string u16EventType =
-      std::u16string(reinterpret_cast<const char16_t*>(native_string->string()), native_string->length());
-  return toUTF8(u16EventType);
+  return toUTF8(native_string->string(), native_string->length());
+}
+
+std::string toUTF8(const uint16_t* source, size_t length) {
+  std::string result;
+  result.resize(UTF8LengthOfUTF16(source, length));
+  ConvertUTF16ToUTF8(source, length, &result[0]);
+  return result;
 }
 
 std::unique_ptr<SharedNativeString> atomToNativeString(JSContext* ctx, JSAtom atom) {
@@ -7,12 +7,11 @@
 #define BRIDGE_NATIVE_STRING_UTILS_H
 
 #include <quickjs/quickjs.h>
-#include <codecvt>
-#include <locale>
 #include <memory>
 #include <string>
 
 #include "foundation/native_string.h"
+#include "foundation/utf_transcoding.h"
 
 namespace mercury {
 
@@ -24,20 +23,21 @@ std::unique_ptr<SharedNativeString> stringToNativeString(const std::string& stri
 
 std::string nativeStringToStdString(const SharedNativeString* native_string);
 
+std::string toUTF8(const uint16_t* source, size_t length);
+
 template <typename T>
 std::string toUTF8(const std::basic_string<T, std::char_traits<T>, std::allocator<T>>& source) {
-  std::string result;
-
-  std::wstring_convert<std::codecvt_utf8_utf16<T>, T> convertor;
-  result = convertor.to_bytes(source);
-
-  return result;
+  static_assert(sizeof(T) == sizeof(uint16_t), "UTF-16 code units are expected");
+  return toUTF8(reinterpret_cast<const uint16_t*>(source.data()), source.size());
 }
 
 template <typename T>
 void fromUTF8(const std::string& source, std::basic_string<T, std::char_traits<T>, std::allocator<T>>& result) {
-  std::wstring_convert<std::codecvt_utf8_utf16<T>, T> convertor;
-  result = convertor.from_bytes(source);
+  static_assert(sizeof(T) == sizeof(uint16_t), "UTF-16 code units are expected");
+  // The count of bytes is the upper bound of code units.
+  result.resize(source.size());
+  size_t length = ConvertUTF8ToUTF16(source.data(), source.size(), reinterpret_cast<uint16_t*>(&result[0]));
+  result.resize(length);
 }
 
 }  // namespace mercury
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_typed_array_registry.h"
+
+namespace mercury {
+
+NativeTypedArrayRegistry::DetachedStore::~DetachedStore() {
+  if (store.free_func != nullptr) {
+    store.free_func(runtime, store.opaque, store.data);
+  }
+}
+
+NativeTypedArray* NativeTypedArrayRegistry::Retain(JSContext* ctx,
+                                                   uint8_t* bytes,
+                                                   int64_t byte_length,
+                                                   NativeTypedArrayType type,
+                                                   JSValue buffer) {
+  auto* record = new NativeTypedArray{bytes, byte_length, static_cast<int32_t>(type), next_id_++};
+  entries_.emplace(record->id, Entry{std::unique_ptr<NativeTypedArray>(record), ctx, JS_DupValue(ctx, buffer)});
+  return record;
+}
+
+void NativeTypedArrayRegistry::Release(int64_t id) {
+  auto it = entries_.find(id);
+  if (it == entries_.end())
+    return;
+  if (it->second.ctx != nullptr) {
+    JS_FreeValue(it->second.ctx, it->second.buffer);
+  }
+  entries_.erase(it);
+}
+
+void NativeTypedArrayRegistry::DetachContext(JSContext* ctx) {
+  // Views of one buffer share its backing store.
+  std::unordered_map<void*, std::shared_ptr<DetachedStore>> detached_stores;
+  for (auto& it : entries_) {
+    Entry& entry = it.second;
+    if (entry.ctx != ctx)
+      continue;
+
+    std::shared_ptr<DetachedStore>& detached_store = detached_stores[JS_VALUE_GET_PTR(entry.buffer)];
+    if (detached_store == nullptr) {
+      detached_store = std::make_shared<DetachedStore>();
+      detached_store->runtime = JS_GetRuntime(ctx);
+      if (!JS_DetachArrayBufferStore(ctx, entry.buffer, &detached_store->store)) {
+        detached_store->store = {};
+      }
+    }
+    entry.detached_store = detached_store;
+    JS_FreeValue(ctx, entry.buffer);
+    entry.ctx = nullptr;
+    entry.buffer = JS_UNDEFINED;
+  }
+}
+
+}  // namespace mercury
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_BINDINGS_QJS_NATIVE_TYPED_ARRAY_REGISTRY_H_
+#define BRIDGE_BINDINGS_QJS_NATIVE_TYPED_ARRAY_REGISTRY_H_
+
+#include <quickjs/quickjs.h>
+#include <memory>
+#include <unordered_map>
+#include "foundation/native_value.h"
+#include "qjs_engine_patch.h"
+
+namespace mercury {
+
+// Records of the JS buffers shared with dart without copying, see NativeTypedArray. Dart views may outlive the
+// context which created them, so the records are kept per dart isolate and released by id from the view finalizers.
+class NativeTypedArrayRegistry {
+ public:
+  NativeTypedArrayRegistry() = default;
+
+  // Retains |buffer|, the ArrayBuffer owning |bytes|, until the record is released.
+  NativeTypedArray* Retain(JSContext* ctx,
+                           uint8_t* bytes,
+                           int64_t byte_length,
+                           NativeTypedArrayType type,
+                           JSValue buffer);
+  // Does nothing when |id| was already released.
+  void Release(int64_t id);
+  // Called before |ctx| is freed. The buffers dart still has views of are detached from JS, their backing stores are
+  // kept until the last record using them is released.
+  void DetachContext(JSContext* ctx);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  // Frees a backing store taken from a disposed context.
+  struct DetachedStore {
+    ~DetachedStore();
+    JSRuntime* runtime;
+    JSArrayBufferStore store;
+  };
+
+  struct Entry {
+    std::unique_ptr<NativeTypedArray> record;
+    // Null once the context is disposed.
+    JSContext* ctx;
+    JSValue buffer;
+    std::shared_ptr<DetachedStore> detached_store;
+  };
+
+  int64_t next_id_{1};
+  std::unordered_map<int64_t, Entry> entries_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_BINDINGS_QJS_NATIVE_TYPED_ARRAY_REGISTRY_H_
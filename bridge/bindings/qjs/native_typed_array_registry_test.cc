@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_typed_array_registry.h"
+#include <string>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+static NativeTypedArray* RetainTypedArray(NativeTypedArrayRegistry& registry, JSContext* ctx, const std::string& code) {
+  JSValue array = JS_Eval(ctx, code.c_str(), code.size(), "vm://", JS_EVAL_TYPE_GLOBAL);
+  size_t byte_offset;
+  size_t byte_length;
+  size_t bytes_per_element;
+  size_t buffer_length;
+  JSValue buffer = JS_GetTypedArrayBuffer(ctx, array, &byte_offset, &byte_length, &bytes_per_element);
+  uint8_t* bytes = JS_GetArrayBuffer(ctx, &buffer_length, buffer);
+  NativeTypedArray* record = registry.Retain(ctx, bytes + byte_offset, static_cast<int64_t>(byte_length),
+                                             NativeTypedArrayType::kUint8, buffer);
+  JS_FreeValue(ctx, buffer);
+  JS_FreeValue(ctx, array);
+  return record;
+}
+
+TEST(NativeTypedArrayRegistry, release) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    NativeTypedArrayRegistry registry;
+    NativeTypedArray* record = RetainTypedArray(registry, ctx, "new Uint8Array([1, 2, 3])");
+    EXPECT_EQ(record->byte_length, 3);
+    EXPECT_EQ(record->bytes[2], 3);
+    int64_t id = record->id;
+    registry.Release(id);
+    EXPECT_EQ(registry.size(), 0);
+    // A second release from a late finalizer is ignored.
+    registry.Release(id);
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(NativeTypedArrayRegistry, bytesOutliveDisposedContext) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    NativeTypedArrayRegistry registry;
+    std::string code = "globalThis.shared = new Uint8Array([1, 2, 3, 4]); shared";
+    NativeTypedArray* whole = RetainTypedArray(registry, ctx, code);
+    NativeTypedArray* tail = RetainTypedArray(registry, ctx, "shared.subarray(2)");
+
+    registry.DetachContext(ctx);
+    JS_FreeContext(ctx);
+    JS_RunGC(runtime);
+
+    // Both views read the same backing store, which is kept until the last of them is released.
+    EXPECT_EQ(whole->bytes[0], 1);
+    registry.Release(whole->id);
+    EXPECT_EQ(tail->byte_length, 2);
+    EXPECT_EQ(tail->bytes[0], 3);
+    EXPECT_EQ(tail->bytes[1], 4);
+    registry.Release(tail->id);
+    EXPECT_EQ(registry.size(), 0);
+  }
+  JS_FreeRuntime(runtime);
+}
+
+TEST(NativeTypedArrayRegistry, detachContextKeepsOtherContexts) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* disposed = JS_NewContext(runtime);
+  JSContext* ctx = JS_NewContext(runtime);
+  {
+    NativeTypedArrayRegistry registry;
+    RetainTypedArray(registry, disposed, "new Uint8Array([1])");
+    NativeTypedArray* record = RetainTypedArray(registry, ctx, "globalThis.kept = new Uint8Array([5]); kept");
+
+    registry.DetachContext(disposed);
+    JS_FreeContext(disposed);
+
+    // Buffers of live contexts stay attached to JS.
+    JSValue length = JS_Eval(ctx, "kept.length", 11, "vm://", JS_EVAL_TYPE_GLOBAL);
+    EXPECT_EQ(JS_VALUE_GET_INT(length), 1);
+    EXPECT_EQ(record->bytes[0], 5);
+    registry.Release(record->id);
+    EXPECT_EQ(registry.size(), 1);
+  }
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
@@ -150,6 +150,16 @@ typedef struct JSRegExp {
 
 typedef struct JSString JSString;
 
+typedef struct JSArrayBuffer {
+  int byte_length; /* 0 if detached */
+  uint8_t detached;
+  uint8_t shared; /* if shared, the array buffer cannot be detached */
+  uint8_t* data;  /* NULL if detached */
+  struct list_head array_list;
+  void* opaque;
+  JSFreeArrayBufferDataFunc* free_func;
+} JSArrayBuffer;
+
 struct JSObject {
   union {
     JSGCObjectHeader header;
@@ -389,6 +399,24 @@ bool JS_HasClassId(JSRuntime* runtime, JSClassID classId) {
   return runtime->class_array[classId].class_id == classId;
 }
 
+bool JS_DetachArrayBufferStore(JSContext* ctx, JSValueConst obj, JSArrayBufferStore* store) {
+  auto* abuf = static_cast<JSArrayBuffer*>(JS_GetOpaque(obj, JS_CLASS_ARRAY_BUFFER));
+  if (abuf == nullptr || abuf->detached || abuf->shared)
+    return false;
+  *store = {abuf->data, abuf->opaque, abuf->free_func};
+  // Detaching frees nothing without a free function, the typed arrays using the buffer are emptied as usual.
+  abuf->free_func = nullptr;
+  JS_DetachArrayBuffer(ctx, obj);
+  return true;
+}
+
+void JS_SetObjectExotic(JSValue value, bool is_exotic) {
+  if (!JS_IsObject(value))
+    return;
+  JSObject* p = JS_VALUE_GET_OBJ(value);
+  p->is_exotic = is_exotic;
+}
+
 int JS_AtomIs8Bit(JSRuntime* runtime, JSAtom atom) {
   if (JS_AtomIsTaggedInt(atom))
     return true;
@@ -124,6 +124,17 @@ bool JS_IsPromise(JSValue value);
 bool JS_IsArrayBuffer(JSValue value);
 bool JS_IsArrayBufferView(JSValue value);
 bool JS_HasClassId(JSRuntime* runtime, JSClassID classId);
+// Backing store of an ArrayBuffer taken over by JS_DetachArrayBufferStore.
+struct JSArrayBufferStore {
+  uint8_t* data;
+  void* opaque;
+  JSFreeArrayBufferDataFunc* free_func;
+};
+// Detaches the ArrayBuffer like JS_DetachArrayBuffer, but hands the backing store to the caller instead of freeing it.
+// The caller frees it with |free_func| before the runtime is freed. Returns false for detached or shared buffers.
+bool JS_DetachArrayBufferStore(JSContext* ctx, JSValueConst obj, JSArrayBufferStore* store);
+// Turns the exotic class hooks of one object on or off, objects of the same class keep theirs.
+void JS_SetObjectExotic(JSValue value, bool is_exotic);
 int JS_AtomIs8Bit(JSRuntime* runtime, JSAtom atom);
 const uint8_t* JS_AtomRawCharacter8(JSRuntime* runtime, JSAtom atom);
 const uint16_t* JS_AtomRawCharacter16(JSRuntime* runtime, JSAtom atom);
@@ -48,6 +48,9 @@ bool QJSFunction::IsFunction(JSContext* ctx) {
 }
 
 ScriptValue QJSFunction::Invoke(JSContext* ctx, const ScriptValue& this_val, int32_t argc, ScriptValue* arguments) {
+  ExecutingContext* context = ExecutingContext::From(ctx);
+  ScriptTurnScope script_turn_scope(context->isolateCommandBuffer());
+
   // 'm_function' might be destroyed when calling itself (if it frees the handler), so must take extra care.
   JS_DupValue(ctx, function_);
 
@@ -59,7 +62,6 @@ ScriptValue QJSFunction::Invoke(JSContext* ctx, const ScriptValue& this_val, int
 
   JSValue returnValue = JS_Call(ctx, function_, this_val.QJSValue(), argc, argv);
 
-  ExecutingContext* context = ExecutingContext::From(ctx);
   context->DrainPendingPromiseJobs();
 
   // Free the previous duplicated function.
@@ -54,7 +54,9 @@ void ScriptPromiseResolver::ResolveOrRejectImmediately(JSValue value) {
       JS_FreeValue(context_->ctx(), return_value);
     }
   }
-  context_->DrainPendingPromiseJobs();
+  if (drain_pending_jobs_) {
+    context_->DrainPendingPromiseJobs();
+  }
 }
 
 }  // namespace mercury
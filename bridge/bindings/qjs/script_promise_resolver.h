@@ -42,6 +42,9 @@ class ScriptPromiseResolver {
 
   void Trace(GCVisitor* visitor) const;
 
+  // Settlements of a batch skip draining the pending promise jobs, the caller drains them once for the whole batch.
+  void SetDrainPendingJobs(bool drain) { drain_pending_jobs_ = drain; }
+
  private:
   enum ResolutionState {
     kPending,
@@ -74,6 +77,7 @@ class ScriptPromiseResolver {
   JSValue promise_{JS_NULL};
   JSValue resolve_func_{JS_NULL};
   JSValue reject_func_{JS_NULL};
+  bool drain_pending_jobs_{true};
 };
 
 }  // namespace mercury
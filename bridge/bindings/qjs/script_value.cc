@@ -9,10 +9,12 @@
 #include "core/binding_object.h"
 #include "core/executing_context.h"
 #include "cppgc/gc_visitor.h"
+#include "foundation/native_value_arena.h"
 #include "foundation/native_value_converter.h"
 #include "native_string_utils.h"
 #include "qjs_engine_patch.h"
 #include "qjs_event_target.h"
+#include "structured_clone.h"
 
 #if WIN32
 #include <Windows.h>
@@ -20,6 +22,23 @@
 
 namespace mercury {
 
+// Materialize a packed list from dart as a dense JS array, and free the elements.
+template <typename T, typename NewValue>
+static JSValue FromPackedList(JSContext* ctx, const NativeValue& native_value, NewValue new_value) {
+  auto* elements = static_cast<T*>(native_value.u.ptr);
+  uint32_t length = native_value.uint32;
+  std::vector<JSValue> values(length);
+  for (uint32_t i = 0; i < length; i++) {
+    values[i] = new_value(ctx, elements[i]);
+  }
+#if WIN32
+  CoTaskMemFree(elements);
+#else
+  free(elements);
+#endif
+  return JS_NewArrayFrom(ctx, length, values.data());
+}
+
 static JSValue FromNativeValue(ExecutingContext* context,
                                const NativeValue& native_value,
                                bool shared_js_value = false) {
@@ -39,6 +58,9 @@ static JSValue FromNativeValue(ExecutingContext* context,
         return returnedValue;
       }
     }
+    case NativeTag::TAG_LATIN1_STRING: {
+      return JS_NewRawUTF8String(context->ctx(), static_cast<const uint8_t*>(native_value.u.ptr), native_value.uint32);
+    }
     case NativeTag::TAG_INT: {
       return JS_NewInt64(context->ctx(), native_value.u.int64);
     }
@@ -64,22 +86,42 @@ static JSValue FromNativeValue(ExecutingContext* context,
                                0);
     }
     case NativeTag::TAG_LIST: {
-      size_t length = native_value.uint32;
+      uint32_t length = native_value.uint32;
       auto* arr = static_cast<NativeValue*>(native_value.u.ptr);
-      JSValue array = JS_NewArray(context->ctx());
-      JS_SetPropertyStr(context->ctx(), array, "length", Converter<IDLInt64>::ToValue(context->ctx(), length));
-      for (int i = 0; i < length; i++) {
-        JSValue value = FromNativeValue(context, arr[i], shared_js_value);
-        JS_SetPropertyInt64(context->ctx(), array, i, value);
+      std::vector<JSValue> values(length);
+      for (uint32_t i = 0; i < length; i++) {
+        values[i] = FromNativeValue(context, arr[i], shared_js_value);
       }
-      return array;
+      return JS_NewArrayFrom(context->ctx(), length, values.data());
     }
+    case NativeTag::TAG_FLOAT64_LIST:
+      return FromPackedList<double>(context->ctx(), native_value,
+                                    [](JSContext* ctx, double value) { return JS_NewFloat64(ctx, value); });
+    case NativeTag::TAG_INT32_LIST:
+      return FromPackedList<int32_t>(context->ctx(), native_value,
+                                     [](JSContext* ctx, int32_t value) { return JS_NewInt32(ctx, value); });
+    case NativeTag::TAG_INT64_LIST:
+      return FromPackedList<int64_t>(context->ctx(), native_value,
+                                     [](JSContext* ctx, int64_t value) { return JS_NewInt64(ctx, value); });
+    case NativeTag::TAG_BOOL_LIST:
+      return FromPackedList<uint8_t>(context->ctx(), native_value,
+                                     [](JSContext* ctx, uint8_t value) { return JS_NewBool(ctx, value != 0); });
     case NativeTag::TAG_JSON: {
       auto* str = static_cast<const char*>(native_value.u.ptr);
       JSValue returnedValue = JS_ParseJSON(context->ctx(), str, strlen(str), "");
       delete str;
       return returnedValue;
     }
+    case NativeTag::TAG_STRUCTURED_CLONE: {
+      auto* bytes = static_cast<uint8_t*>(native_value.u.ptr);
+      JSValue returnedValue = StructuredCloneReader(context->ctx(), bytes, native_value.uint32).Read();
+#if WIN32
+      CoTaskMemFree(bytes);
+#else
+      free(bytes);
+#endif
+      return returnedValue;
+    }
     case NativeTag::TAG_POINTER: {
       auto* ptr = static_cast<NativeBindingObject*>(native_value.u.ptr);
       auto pointer_type = static_cast<JSPointerType>(native_value.uint32);
@@ -123,6 +165,48 @@ ScriptValue ScriptValue::CreateJsonObject(JSContext* ctx, const char* jsonString
   return result;
 }
 
+ScriptValue ScriptValue::CreateFromStructuredClone(JSContext* ctx, const uint8_t* bytes, uint32_t length) {
+  JSValue value = StructuredCloneReader(ctx, bytes, length).Read();
+  ScriptValue result = ScriptValue(ctx, value);
+  JS_FreeValue(ctx, value);
+  return result;
+}
+
+void ScriptValue::ReleaseNativeValue(const NativeValue& native_value) {
+  switch (native_value.tag) {
+    case NativeTag::TAG_STRING:
+      delete static_cast<AutoFreeNativeString*>(native_value.u.ptr);
+      break;
+    case NativeTag::TAG_UINT8_BYTES:
+    case NativeTag::TAG_FLOAT64_LIST:
+    case NativeTag::TAG_INT32_LIST:
+    case NativeTag::TAG_INT64_LIST:
+    case NativeTag::TAG_BOOL_LIST:
+    case NativeTag::TAG_STRUCTURED_CLONE:
+#if WIN32
+      CoTaskMemFree(native_value.u.ptr);
+#else
+      free(native_value.u.ptr);
+#endif
+      break;
+    case NativeTag::TAG_TYPED_ARRAY:
+      // Owned by the context, released when dart finalized its view or at dispose.
+      break;
+    case NativeTag::TAG_LIST: {
+      auto* arr = static_cast<NativeValue*>(native_value.u.ptr);
+      for (uint32_t i = 0; i < native_value.uint32; i++) {
+        ReleaseNativeValue(arr[i]);
+      }
+      break;
+    }
+    case NativeTag::TAG_JSON:
+      delete static_cast<const char*>(native_value.u.ptr);
+      break;
+    default:
+      break;
+  }
+}
+
 ScriptValue ScriptValue::Empty(JSContext* ctx) {
   return ScriptValue(ctx);
 }
@@ -192,47 +276,150 @@ std::unique_ptr<SharedNativeString> ScriptValue::ToNativeString(JSContext* ctx)
   return ToString(ctx).ToNativeString(ctx);
 }
 
-NativeValue ScriptValue::ToNative(JSContext* ctx, ExceptionState& exception_state, bool shared_js_value) const {
-  int8_t tag = JS_VALUE_GET_TAG(value_);
+static bool GetTypedArrayType(JSValue value, NativeTypedArrayType* type) {
+  switch (JSValueGetClassId(value)) {
+    case JS_CLASS_ARRAY_BUFFER:
+      *type = NativeTypedArrayType::kArrayBuffer;
+      return true;
+    case JS_CLASS_INT8_ARRAY:
+      *type = NativeTypedArrayType::kInt8;
+      return true;
+    case JS_CLASS_UINT8_ARRAY:
+      *type = NativeTypedArrayType::kUint8;
+      return true;
+    case JS_CLASS_UINT8C_ARRAY:
+      *type = NativeTypedArrayType::kUint8Clamped;
+      return true;
+    case JS_CLASS_INT16_ARRAY:
+      *type = NativeTypedArrayType::kInt16;
+      return true;
+    case JS_CLASS_UINT16_ARRAY:
+      *type = NativeTypedArrayType::kUint16;
+      return true;
+    case JS_CLASS_INT32_ARRAY:
+      *type = NativeTypedArrayType::kInt32;
+      return true;
+    case JS_CLASS_UINT32_ARRAY:
+      *type = NativeTypedArrayType::kUint32;
+      return true;
+    case JS_CLASS_FLOAT32_ARRAY:
+      *type = NativeTypedArrayType::kFloat32;
+      return true;
+    case JS_CLASS_FLOAT64_ARRAY:
+      *type = NativeTypedArrayType::kFloat64;
+      return true;
+    default:
+      // SharedArrayBuffer, DataView and BigInt arrays are still serialized.
+      return false;
+  }
+}
+
+// Expose the backing store of the buffer to dart without copying, the buffer is retained by the registry of the
+// dart isolate. Returns false for views of shared buffers, which could not be kept past the context.
+static bool ToNativeTypedArray(JSContext* ctx, JSValue value, NativeTypedArrayType type, NativeValue* result) {
+  size_t byte_offset = 0;
+  size_t byte_length = 0;
+  JSValue buffer;
+  if (type == NativeTypedArrayType::kArrayBuffer) {
+    buffer = JS_DupValue(ctx, value);
+  } else {
+    size_t bytes_per_element;
+    buffer = JS_GetTypedArrayBuffer(ctx, value, &byte_offset, &byte_length, &bytes_per_element);
+  }
+
+  if (JSValueGetClassId(buffer) == JS_CLASS_SHARED_ARRAY_BUFFER) {
+    JS_FreeValue(ctx, buffer);
+    return false;
+  }
+
+  size_t buffer_length;
+  uint8_t* bytes = JS_IsException(buffer) ? nullptr : JS_GetArrayBuffer(ctx, &buffer_length, buffer);
+  if (type == NativeTypedArrayType::kArrayBuffer) {
+    byte_length = buffer_length;
+  }
+
+  // Detached buffers.
+  if (bytes == nullptr) {
+    JS_FreeValue(ctx, buffer);
+    JS_FreeValue(ctx, JS_GetException(ctx));
+    *result = Native_NewNull();
+    return true;
+  }
+
+  NativeTypedArrayRegistry* registry =
+      ExecutingContext::From(ctx)->dartIsolateContext()->EnsureData()->nativeTypedArrays();
+  *result = Native_NewTypedArray(
+      registry->Retain(ctx, bytes + byte_offset, static_cast<int64_t>(byte_length), type, buffer));
+  JS_FreeValue(ctx, buffer);
+  return true;
+}
+
+static NativeValue ToNativeValue(JSContext* ctx,
+                                 JSValue value,
+                                 ExceptionState& exception_state,
+                                 bool shared_js_value,
+                                 NativeValueArena* arena) {
+  int8_t tag = JS_VALUE_GET_TAG(value);
 
   switch (tag) {
     case JS_TAG_NULL:
     case JS_TAG_UNDEFINED:
       return Native_NewNull();
     case JS_TAG_BOOL:
-      return Native_NewBool(JS_ToBool(ctx, value_));
+      return Native_NewBool(JS_ToBool(ctx, value));
     case JS_TAG_FLOAT64: {
       double v;
-      JS_ToFloat64(ctx, &v, value_);
+      JS_ToFloat64(ctx, &v, value);
       return Native_NewFloat64(v);
     }
     case JS_TAG_INT: {
       int32_t v;
-      JS_ToInt32(ctx, &v, value_);
+      JS_ToInt32(ctx, &v, value);
       return Native_NewInt64(v);
     }
-    case JS_TAG_STRING:
+    case JS_TAG_STRING: {
+      if (arena != nullptr) {
+        JSString* p = JS_VALUE_GET_STRING(value);
+        return p->is_wide_char ? arena->NewString(p->u.str16, p->len) : arena->NewLatin1String(ctx, value);
+      }
       // NativeString owned by NativeValue will be freed by users.
-      return NativeValueConverter<NativeTypeString>::ToNativeValue(ctx, ToString(ctx));
+      return NativeValueConverter<NativeTypeString>::ToNativeValue(ctx, AtomicString(ctx, value));
+    }
     case JS_TAG_OBJECT: {
-      if (JS_IsArray(ctx, value_)) {
-        std::vector<ScriptValue> values = Converter<IDLSequence<IDLAny>>::FromValue(ctx, value_, ASSERT_NO_EXCEPTION());
-        auto* result = new NativeValue[values.size()];
+      if (JS_IsArray(ctx, value)) {
+        std::vector<ScriptValue> values = Converter<IDLSequence<IDLAny>>::FromValue(ctx, value, ASSERT_NO_EXCEPTION());
+        auto* result = arena != nullptr ? arena->AllocateValues(values.size()) : new NativeValue[values.size()];
         for (int i = 0; i < values.size(); i++) {
-          result[i] = values[i].ToNative(ctx, exception_state, shared_js_value);
+          result[i] = ToNativeValue(ctx, values[i].QJSValue(), exception_state, shared_js_value, arena);
         }
         return Native_NewList(values.size(), result);
-      } else if (JS_IsObject(value_)) {
-        if (QJSEventTarget::HasInstance(ExecutingContext::From(ctx), value_)) {
-          auto* event_target = toScriptWrappable<EventTarget>(value_);
+      } else if (JS_IsObject(value)) {
+        if (QJSEventTarget::HasInstance(ExecutingContext::From(ctx), value)) {
+          auto* event_target = toScriptWrappable<EventTarget>(value);
           return Native_NewPtr(JSPointerType::NativeBindingObject, event_target->bindingObject());
         }
 
         if (shared_js_value) {
-          return Native_NewPtr(JSPointerType::Others, JS_VALUE_GET_PTR(value_));
+          return Native_NewPtr(JSPointerType::Others, JS_VALUE_GET_PTR(value));
         }
 
-        return NativeValueConverter<NativeTypeJSON>::ToNativeValue(ctx, *this, exception_state);
+        NativeTypedArrayType typed_array_type;
+        NativeValue typed_array;
+        if (GetTypedArrayType(value, &typed_array_type) &&
+            ToNativeTypedArray(ctx, value, typed_array_type, &typed_array)) {
+          return typed_array;
+        }
+
+        if (arena != nullptr) {
+          StructuredCloneWriter writer(ctx);
+          if (!writer.Write(value)) {
+            exception_state.ThrowException(ctx, JS_EXCEPTION);
+            return Native_NewNull();
+          }
+          return arena->NewBytes(NativeTag::TAG_STRUCTURED_CLONE, writer.data(), writer.length());
+        }
+
+        return NativeValueConverter<NativeTypeJSON>::ToNativeValue(ctx, ScriptValue(ctx, value), exception_state);
       }
     }
     default:
@@ -240,6 +427,14 @@ NativeValue ScriptValue::ToNative(JSContext* ctx, ExceptionState& exception_stat
   }
 }
 
+NativeValue ScriptValue::ToNative(JSContext* ctx, ExceptionState& exception_state, bool shared_js_value) const {
+  return ToNativeValue(ctx, value_, exception_state, shared_js_value, nullptr);
+}
+
+NativeValue ScriptValue::ToNative(JSContext* ctx, NativeValueArena* arena, ExceptionState& exception_state) const {
+  return ToNativeValue(ctx, value_, exception_state, false, arena);
+}
+
 bool ScriptValue::IsException() const {
   return JS_IsException(value_);
 }
@@ -21,6 +21,7 @@ class ExecutingContext;
 class WrapperTypeInfo;
 struct NativeValue;
 class GCVisitor;
+class NativeValueArena;
 
 // ScriptValue is a stack allocate only QuickJS JSValue wrapper ScriptValuewhich hold all information to hide out
 // QuickJS running details.
@@ -33,6 +34,10 @@ class ScriptValue final {
   static ScriptValue CreateErrorObject(JSContext* ctx, const char* errmsg);
   // Create an object from JSON string.
   static ScriptValue CreateJsonObject(JSContext* ctx, const char* jsonString, size_t length);
+  // Decode the bytes written by StructuredCloneWriter.
+  static ScriptValue CreateFromStructuredClone(JSContext* ctx, const uint8_t* bytes, uint32_t length);
+  // Free the buffers owned by a native value sent from dart which is dropped without being converted.
+  static void ReleaseNativeValue(const NativeValue& native_value);
 
   // Create an empty ScriptValue;
   static ScriptValue Empty(JSContext* ctx);
@@ -66,6 +71,8 @@ class ScriptValue final {
   AtomicString ToLegacyDOMString(JSContext* ctx) const;
   std::unique_ptr<SharedNativeString> ToNativeString(JSContext* ctx) const;
   NativeValue ToNative(JSContext* ctx, ExceptionState& exception_state, bool shared_js_value = false) const;
+  // Allocate the strings and lists of the result in the arena, which must outlive the synchronous call to dart.
+  NativeValue ToNative(JSContext* ctx, NativeValueArena* arena, ExceptionState& exception_state) const;
 
   bool IsException() const;
   bool IsEmpty() const;
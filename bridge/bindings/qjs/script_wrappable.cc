@@ -103,10 +103,10 @@ static int HandleJSPropertySetterCallback(JSContext* ctx,
     return is_success;
   }
 
-  ExecutingContext* context = ExecutingContext::From(ctx);
-  JSValue prototypeObject = context->contextData()->prototypeForType(wrapper_type_info);
+  // Look up from the actual prototype of this object, instances may be switched to a generated prototype.
+  JSValue prototypeObject = JS_GetPrototype(ctx, obj);
   if (JS_HasProperty(ctx, prototypeObject, atom)) {
-    JSValue target = JS_DupValue(ctx, prototypeObject);
+    JSValue target = prototypeObject;
     JSValue setterFunc = JS_UNDEFINED;
     while (JS_IsUndefined(setterFunc) && JS_IsObject(target)) {
       JSPropertyDescriptor descriptor;
@@ -144,6 +144,7 @@ static int HandleJSPropertySetterCallback(JSContext* ctx,
     return true;
   }
 
+  JS_FreeValue(ctx, prototypeObject);
   return false;
 }
 
@@ -281,12 +282,13 @@ void ScriptWrappable::InitializeQuickJSObject() {
   /// within JavaScript code. When the reference count of `jsObject` decrease to 0, QuickJS will trigger `finalizer`
   /// callback and free `jsObject` memory. When QuickJS GC found `jsObject` at marking stage, `gc_mark` callback will be
   /// triggered.
-  jsObject_ = JS_NewObjectClass(ctx_, wrapper_type_info->classId);
+  // Create it with its prototype in place, so instances of a class share one QuickJS shape.
+  jsObject_ = JS_NewObjectProtoClass(ctx_, InitialPrototype(), wrapper_type_info->classId);
   JS_SetOpaque(jsObject_, this);
+}
 
-  // Let our instance into inherit prototype methods.
-  JSValue prototype = GetExecutingContext()->contextData()->prototypeForType(wrapper_type_info);
-  JS_SetPrototype(ctx_, jsObject_, prototype);
+JSValue ScriptWrappable::InitialPrototype() {
+  return GetExecutingContext()->contextData()->prototypeForType(GetWrapperTypeInfo());
 }
 
 void ScriptWrappable::KeepAlive() {
@@ -65,6 +65,10 @@ class ScriptWrappable : public GarbageCollected<ScriptWrappable> {
   void KeepAlive();
   void ReleaseAlive();
 
+ protected:
+  // The prototype the JavaScript object is created with, defaults to the prototype of the wrapper type.
+  virtual JSValue InitialPrototype();
+
  private:
   bool is_alive = false;
   JSValue jsObject_{JS_NULL};
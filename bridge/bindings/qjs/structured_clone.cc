@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "structured_clone.h"
+#include <cmath>
+#include <cstring>
+#include "qjs_engine_patch.h"
+
+namespace mercury {
+
+// Numbers beyond this range are not guaranteed to be integral after they are decoded as double.
+static constexpr double kMaxSafeInteger = 9007199254740991.0;
+
+static bool IsDroppedFromObject(JSContext* ctx, JSValueConst value) {
+  return JS_IsUndefined(value) || JS_IsSymbol(value) || JS_IsFunction(ctx, value);
+}
+
+static bool IsASCII(const std::string& string) {
+  for (char c : string) {
+    if (static_cast<uint8_t>(c) > 0x7f)
+      return false;
+  }
+  return true;
+}
+
+bool StructuredCloneWriter::Write(JSValueConst value) {
+  bytes_.clear();
+  Reset();
+  if (to_json_atom_ == JS_ATOM_NULL)
+    to_json_atom_ = JS_NewAtom(ctx_, "toJSON");
+  WriteVarUint(STRUCTURED_CLONE_VERSION);
+
+  JSValue root = ApplyToJSON(JS_DupValue(ctx_, value), JS_ATOM_NULL);
+  if (JS_IsException(root))
+    return false;
+  bool success = WriteValue(root, 0);
+  JS_FreeValue(ctx_, root);
+  return success;
+}
+
+StructuredCloneWriter::~StructuredCloneWriter() {
+  Reset();
+  if (to_json_atom_ != JS_ATOM_NULL)
+    JS_FreeAtom(ctx_, to_json_atom_);
+}
+
+void StructuredCloneWriter::Reset() {
+  for (JSValue object : retained_objects_) {
+    JS_FreeValue(ctx_, object);
+  }
+  retained_objects_.clear();
+  objects_.clear();
+  for (auto& entry : keys_) {
+    JS_FreeAtom(ctx_, entry.first);
+  }
+  keys_.clear();
+}
+
+JSValue StructuredCloneWriter::ApplyToJSON(JSValue value, JSAtom key) {
+  if (!JS_IsObject(value))
+    return value;
+  JSValue to_json = JS_GetProperty(ctx_, value, to_json_atom_);
+  if (!JS_IsFunction(ctx_, to_json)) {
+    if (JS_IsException(to_json)) {
+      JS_FreeValue(ctx_, value);
+      return to_json;
+    }
+    JS_FreeValue(ctx_, to_json);
+    return value;
+  }
+
+  JSValue key_string = key == JS_ATOM_NULL ? JS_NewString(ctx_, "") : JS_AtomToString(ctx_, key);
+  JSValue result = JS_Call(ctx_, to_json, value, 1, &key_string);
+  JS_FreeValue(ctx_, key_string);
+  JS_FreeValue(ctx_, to_json);
+  JS_FreeValue(ctx_, value);
+  return result;
+}
+
+bool StructuredCloneWriter::WriteValue(JSValueConst value, int32_t depth) {
+  switch (JS_VALUE_GET_TAG(value)) {
+    case JS_TAG_BOOL:
+      WriteTag(JS_VALUE_GET_BOOL(value) ? StructuredCloneTag::kTrue : StructuredCloneTag::kFalse);
+      return true;
+    case JS_TAG_INT:
+      WriteTag(StructuredCloneTag::kInt);
+      WriteVarInt(JS_VALUE_GET_INT(value));
+      return true;
+    case JS_TAG_FLOAT64: {
+      double number = JS_VALUE_GET_FLOAT64(value);
+      if (!std::isfinite(number))
+        break;
+      // Integral numbers are decoded as int at the Dart side, same as the result of jsonDecode.
+      if (std::trunc(number) == number && std::fabs(number) <= kMaxSafeInteger &&
+          !(number == 0 && std::signbit(number))) {
+        WriteTag(StructuredCloneTag::kInt);
+        WriteVarInt(static_cast<int64_t>(number));
+      } else {
+        WriteTag(StructuredCloneTag::kDouble);
+        WriteDouble(number);
+      }
+      return true;
+    }
+    case JS_TAG_STRING:
+      WriteTag(StructuredCloneTag::kString);
+      WriteString(value);
+      return true;
+    case JS_TAG_OBJECT: {
+      if (JS_IsFunction(ctx_, value))
+        break;
+      if (depth >= STRUCTURED_CLONE_MAX_DEPTH) {
+        JS_ThrowRangeError(ctx_, "Maximum structured clone depth exceeded");
+        return false;
+      }
+      if (WriteBackReference(value))
+        return true;
+      int is_array = JS_IsArray(ctx_, value);
+      if (is_array < 0)
+        return false;
+      return is_array ? WriteArray(value, depth + 1) : WriteObject(value, depth + 1);
+    }
+    case JS_TAG_BIG_INT:
+    case JS_TAG_BIG_FLOAT:
+    case JS_TAG_BIG_DECIMAL:
+      JS_ThrowTypeError(ctx_, "Do not know how to serialize a BigInt");
+      return false;
+    default:
+      break;
+  }
+
+  // null, undefined and the values JSON can not represent.
+  WriteTag(StructuredCloneTag::kNull);
+  return true;
+}
+
+bool StructuredCloneWriter::WriteBackReference(JSValueConst object) {
+  auto it = objects_.find(JS_VALUE_GET_PTR(object));
+  if (it == objects_.end())
+    return false;
+  WriteTag(StructuredCloneTag::kBackReference);
+  WriteVarUint(it->second);
+  return true;
+}
+
+bool StructuredCloneWriter::WriteArray(JSValueConst array, int32_t depth) {
+  objects_.emplace(JS_VALUE_GET_PTR(array), objects_.size());
+  retained_objects_.push_back(JS_DupValue(ctx_, array));
+
+  JSValue length_value = JS_GetPropertyStr(ctx_, array, "length");
+  uint32_t length;
+  int result = JS_ToUint32(ctx_, &length, length_value);
+  JS_FreeValue(ctx_, length_value);
+  if (result < 0)
+    return false;
+
+  WriteTag(StructuredCloneTag::kArray);
+  WriteVarUint(length);
+  for (uint32_t i = 0; i < length; i++) {
+    JSValue value = JS_GetPropertyUint32(ctx_, array, i);
+    if (JS_IsObject(value)) {
+      JSAtom key = JS_NewAtomUInt32(ctx_, i);
+      value = ApplyToJSON(value, key);
+      JS_FreeAtom(ctx_, key);
+    }
+    if (JS_IsException(value))
+      return false;
+    bool success = WriteValue(value, depth);
+    JS_FreeValue(ctx_, value);
+    if (!success)
+      return false;
+  }
+  return true;
+}
+
+bool StructuredCloneWriter::WriteObject(JSValueConst object, int32_t depth) {
+  objects_.emplace(JS_VALUE_GET_PTR(object), objects_.size());
+  retained_objects_.push_back(JS_DupValue(ctx_, object));
+
+  JSPropertyEnum* properties;
+  uint32_t count;
+  if (JS_GetOwnPropertyNames(ctx_, &properties, &count, object, JS_GPN_STRING_MASK | JS_GPN_ENUM_ONLY) < 0)
+    return false;
+
+  WriteTag(StructuredCloneTag::kObject);
+  bool success = true;
+  for (uint32_t i = 0; i < count; i++) {
+    if (success) {
+      JSValue value = ApplyToJSON(JS_GetProperty(ctx_, object, properties[i].atom), properties[i].atom);
+      if (JS_IsException(value)) {
+        success = false;
+      } else if (!IsDroppedFromObject(ctx_, value)) {
+        WriteKey(properties[i].atom);
+        success = WriteValue(value, depth);
+      }
+      JS_FreeValue(ctx_, value);
+    }
+    JS_FreeAtom(ctx_, properties[i].atom);
+  }
+  js_free(ctx_, properties);
+
+  WriteVarUint(0);
+  return success;
+}
+
+void StructuredCloneWriter::WriteString(JSValueConst string) {
+  JSString* p = JS_VALUE_GET_STRING(string);
+  WriteCharacters(p->u.str8, p->len, p->is_wide_char);
+}
+
+void StructuredCloneWriter::WriteKey(JSAtom atom) {
+  auto it = keys_.find(atom);
+  if (it != keys_.end()) {
+    WriteVarUint(it->second + 2);
+    return;
+  }
+
+  // Keep the atom alive, so the id can not be reused by another key while writing.
+  keys_.emplace(JS_DupAtom(ctx_, atom), keys_.size());
+  WriteVarUint(1);
+  if (JS_AtomIsTaggedInt(atom)) {
+    std::string index = std::to_string(JS_AtomToUInt32(atom));
+    WriteCharacters(index.data(), index.size(), false);
+  } else {
+    StringView view = JSAtomToStringView(JS_GetRuntime(ctx_), atom);
+    if (view.Is8Bit()) {
+      WriteCharacters(view.Characters8(), view.length(), false);
+    } else {
+      WriteCharacters(view.Characters16(), view.length(), true);
+    }
+  }
+}
+
+void StructuredCloneWriter::WriteCharacters(const void* characters, uint32_t length, bool is_utf16) {
+  WriteVarUint(static_cast<uint64_t>(length) << 1 | (is_utf16 ? 1 : 0));
+  size_t byte_length = is_utf16 ? length * sizeof(uint16_t) : length;
+  auto* begin = static_cast<const uint8_t*>(characters);
+  bytes_.insert(bytes_.end(), begin, begin + byte_length);
+}
+
+void StructuredCloneWriter::WriteVarUint(uint64_t value) {
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    bytes_.push_back(byte);
+  } while (value != 0);
+}
+
+void StructuredCloneWriter::WriteVarInt(int64_t value) {
+  bool more = true;
+  while (more) {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if ((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0)) {
+      more = false;
+    } else {
+      byte |= 0x80;
+    }
+    bytes_.push_back(byte);
+  }
+}
+
+void StructuredCloneWriter::WriteDouble(double value) {
+  uint8_t bytes[sizeof(double)];
+  memcpy(bytes, &value, sizeof(double));
+  bytes_.insert(bytes_.end(), bytes, bytes + sizeof(double));
+}
+
+StructuredCloneReader::~StructuredCloneReader() {
+  for (JSAtom key : keys_) {
+    JS_FreeAtom(ctx_, key);
+  }
+}
+
+JSValue StructuredCloneReader::Read() {
+  uint64_t version;
+  if (!ReadVarUint(&version) || version != STRUCTURED_CLONE_VERSION)
+    return ThrowMalformed();
+  return ReadValue(0);
+}
+
+JSValue StructuredCloneReader::ReadValue(int32_t depth) {
+  if (offset_ >= length_ || depth >= STRUCTURED_CLONE_MAX_DEPTH)
+    return ThrowMalformed();
+
+  switch (static_cast<StructuredCloneTag>(bytes_[offset_++])) {
+    case StructuredCloneTag::kNull:
+      return JS_NULL;
+    case StructuredCloneTag::kFalse:
+      return JS_FALSE;
+    case StructuredCloneTag::kTrue:
+      return JS_TRUE;
+    case StructuredCloneTag::kInt: {
+      int64_t value;
+      if (!ReadVarInt(&value))
+        return ThrowMalformed();
+      return JS_NewInt64(ctx_, value);
+    }
+    case StructuredCloneTag::kDouble: {
+      double value;
+      if (!ReadDouble(&value))
+        return ThrowMalformed();
+      return JS_NewFloat64(ctx_, value);
+    }
+    case StructuredCloneTag::kString:
+      return ReadString();
+    case StructuredCloneTag::kArray:
+      return ReadArray(depth + 1);
+    case StructuredCloneTag::kObject:
+      return ReadObject(depth + 1);
+    case StructuredCloneTag::kBackReference: {
+      uint64_t index;
+      if (!ReadVarUint(&index) || index >= objects_.size())
+        return ThrowMalformed();
+      return JS_DupValue(ctx_, objects_[index]);
+    }
+  }
+  return ThrowMalformed();
+}
+
+JSValue StructuredCloneReader::ReadArray(int32_t depth) {
+  uint64_t length;
+  // Every element takes at least one byte.
+  if (!ReadVarUint(&length) || length > length_ - offset_)
+    return ThrowMalformed();
+
+  JSValue array = JS_NewArray(ctx_);
+  objects_.push_back(array);
+  for (uint32_t i = 0; i < length; i++) {
+    JSValue value = ReadValue(depth);
+    if (JS_IsException(value)) {
+      JS_FreeValue(ctx_, array);
+      return value;
+    }
+    JS_SetPropertyUint32(ctx_, array, i, value);
+  }
+  return array;
+}
+
+JSValue StructuredCloneReader::ReadObject(int32_t depth) {
+  JSValue object = JS_NewObject(ctx_);
+  objects_.push_back(object);
+  JSAtom key;
+  while (true) {
+    if (!ReadKey(&key)) {
+      JS_FreeValue(ctx_, object);
+      return ThrowMalformed();
+    }
+    if (key == JS_ATOM_NULL)
+      break;
+    JSValue value = ReadValue(depth);
+    if (JS_IsException(value)) {
+      JS_FreeValue(ctx_, object);
+      return value;
+    }
+    JS_DefinePropertyValue(ctx_, object, key, value, JS_PROP_C_W_E);
+  }
+  return object;
+}
+
+JSValue StructuredCloneReader::ReadString() {
+  std::string latin1;
+  std::u16string utf16;
+  bool is_utf16;
+  if (!ReadCharacters(&latin1, &utf16, &is_utf16))
+    return ThrowMalformed();
+
+  // One-byte strings are created without widening, JS_NewRawUTF8String copies the bytes as Latin-1.
+  if (!is_utf16)
+    return JS_NewRawUTF8String(ctx_, reinterpret_cast<const uint8_t*>(latin1.data()), latin1.size());
+  return JS_NewUnicodeString(ctx_, reinterpret_cast<const uint16_t*>(utf16.data()), utf16.size());
+}
+
+bool StructuredCloneReader::ReadKey(JSAtom* key) {
+  uint64_t index;
+  if (!ReadVarUint(&index))
+    return false;
+
+  // End of the object.
+  if (index == 0) {
+    *key = JS_ATOM_NULL;
+    return true;
+  }
+
+  if (index > 1) {
+    if (index - 2 >= keys_.size())
+      return false;
+    *key = keys_[index - 2];
+    return true;
+  }
+
+  std::string latin1;
+  std::u16string utf16;
+  bool is_utf16;
+  if (!ReadCharacters(&latin1, &utf16, &is_utf16))
+    return false;
+
+  if (!is_utf16 && IsASCII(latin1)) {
+    *key = JS_NewAtomLen(ctx_, latin1.data(), latin1.size());
+  } else {
+    if (!is_utf16)
+      utf16.assign(latin1.begin(), latin1.end());
+    *key = JS_NewUnicodeAtom(ctx_, reinterpret_cast<const uint16_t*>(utf16.data()), utf16.size());
+  }
+  keys_.push_back(*key);
+  return true;
+}
+
+bool StructuredCloneReader::ReadCharacters(std::string* latin1, std::u16string* utf16, bool* is_utf16) {
+  uint64_t header;
+  if (!ReadVarUint(&header))
+    return false;
+
+  uint64_t length = header >> 1;
+  *is_utf16 = (header & 1) != 0;
+  uint64_t byte_length = *is_utf16 ? length * sizeof(char16_t) : length;
+  if (byte_length > length_ - offset_)
+    return false;
+
+  if (*is_utf16) {
+    utf16->resize(length);
+    memcpy(&(*utf16)[0], bytes_ + offset_, byte_length);
+  } else {
+    latin1->assign(reinterpret_cast<const char*>(bytes_ + offset_), length);
+  }
+  offset_ += byte_length;
+  return true;
+}
+
+bool StructuredCloneReader::ReadVarUint(uint64_t* value) {
+  uint64_t result = 0;
+  uint32_t shift = 0;
+  uint8_t byte;
+  do {
+    if (offset_ >= length_ || shift >= 64)
+      return false;
+    byte = bytes_[offset_++];
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  *value = result;
+  return true;
+}
+
+bool StructuredCloneReader::ReadVarInt(int64_t* value) {
+  // Accumulate unsigned, shifting a signed value into the sign bit is undefined.
+  uint64_t result = 0;
+  uint32_t shift = 0;
+  uint8_t byte;
+  do {
+    if (offset_ >= length_ || shift >= 64)
+      return false;
+    byte = bytes_[offset_++];
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  if (shift < 64 && (byte & 0x40))
+    result |= ~static_cast<uint64_t>(0) << shift;
+  *value = static_cast<int64_t>(result);
+  return true;
+}
+
+bool StructuredCloneReader::ReadDouble(double* value) {
+  if (length_ - offset_ < sizeof(double))
+    return false;
+  memcpy(value, bytes_ + offset_, sizeof(double));
+  offset_ += sizeof(double);
+  return true;
+}
+
+JSValue StructuredCloneReader::ThrowMalformed() {
+  return JS_ThrowTypeError(ctx_, "Malformed structured clone data");
+}
+
+}  // namespace mercury
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_BINDINGS_QJS_STRUCTURED_CLONE_H_
+#define BRIDGE_BINDINGS_QJS_STRUCTURED_CLONE_H_
+
+#include <quickjs/quickjs.h>
+#include <cinttypes>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mercury {
+
+// Bump this version when the layout changes, must be the same as structuredCloneVersion at the Dart side.
+#define STRUCTURED_CLONE_VERSION 1
+// Nesting deeper than this is rejected, same as the stack limit of JSON.stringify in practice.
+#define STRUCTURED_CLONE_MAX_DEPTH 256
+
+enum class StructuredCloneTag : uint8_t {
+  kNull = 0,
+  kFalse = 1,
+  kTrue = 2,
+  kInt = 3,
+  kDouble = 4,
+  kString = 5,
+  kArray = 6,
+  kObject = 7,
+  kBackReference = 8,
+};
+
+// Compact binary replacement of JSON for object payloads exchanged with the Dart side:
+//
+//   clone   := version:uleb value
+//   value   := tag:u8 payload
+//   int     := sleb
+//   double  := 8 bytes in little-endian
+//   string  := header:uleb (length << 1 | is_utf16) payload
+//   array   := length:uleb value*
+//   object  := (key value)* 0
+//   key     := 1 string (new key) | uleb (index of a previous key + 2)
+//   backref := uleb (index of a previous array or object)
+//
+// Arrays and objects are numbered in the order they are first written, so shared and cyclic references are written
+// once. Otherwise values are serialized as JSON.stringify does: toJSON is called, values which JSON drops (undefined,
+// functions and symbols) are dropped from objects and become null in arrays, NaN and Infinity become null and BigInt
+// throws.
+class StructuredCloneWriter {
+ public:
+  explicit StructuredCloneWriter(JSContext* ctx) : ctx_(ctx) {}
+  ~StructuredCloneWriter();
+
+  // Return false with a pending exception in the context if the value can not be serialized.
+  bool Write(JSValueConst value);
+
+  const uint8_t* data() const { return bytes_.data(); }
+  uint32_t length() const { return static_cast<uint32_t>(bytes_.size()); }
+
+ private:
+  bool WriteValue(JSValueConst value, int32_t depth);
+  // Replace |value| by the result of its toJSON method, |key| is JS_ATOM_NULL for the root value.
+  JSValue ApplyToJSON(JSValue value, JSAtom key);
+  bool WriteArray(JSValueConst array, int32_t depth);
+  bool WriteObject(JSValueConst object, int32_t depth);
+  // Return true if the value has been written as a back reference.
+  bool WriteBackReference(JSValueConst object);
+  void WriteString(JSValueConst string);
+  void WriteKey(JSAtom atom);
+  void WriteCharacters(const void* characters, uint32_t length, bool is_utf16);
+  void WriteTag(StructuredCloneTag tag) { bytes_.push_back(static_cast<uint8_t>(tag)); }
+  void WriteVarUint(uint64_t value);
+  void WriteVarInt(int64_t value);
+  void WriteDouble(double value);
+  // Objects and keys are numbered per write.
+  void Reset();
+
+  JSContext* ctx_;
+  std::vector<uint8_t> bytes_;
+  // Keyed by address, the objects are retained so the addresses can not be reused while writing.
+  std::unordered_map<void*, uint32_t> objects_;
+  std::vector<JSValue> retained_objects_;
+  JSAtom to_json_atom_{JS_ATOM_NULL};
+  std::unordered_map<JSAtom, uint32_t> keys_;
+};
+
+class StructuredCloneReader {
+ public:
+  StructuredCloneReader(JSContext* ctx, const uint8_t* bytes, uint32_t length)
+      : ctx_(ctx), bytes_(bytes), length_(length) {}
+  ~StructuredCloneReader();
+
+  // Return JS_EXCEPTION if the bytes are malformed.
+  JSValue Read();
+
+ private:
+  JSValue ReadValue(int32_t depth);
+  JSValue ReadArray(int32_t depth);
+  JSValue ReadObject(int32_t depth);
+  JSValue ReadString();
+  // The key is JS_ATOM_NULL at the end of the object, return false if malformed.
+  bool ReadKey(JSAtom* key);
+  // Read the characters of a string into either buffer, return false if out of bounds.
+  bool ReadCharacters(std::string* latin1, std::u16string* utf16, bool* is_utf16);
+  bool ReadVarUint(uint64_t* value);
+  bool ReadVarInt(int64_t* value);
+  bool ReadDouble(double* value);
+  JSValue ThrowMalformed();
+
+  JSContext* ctx_;
+  const uint8_t* bytes_;
+  uint32_t length_;
+  uint32_t offset_{0};
+  // Weak references, the values are owned by their parents.
+  std::vector<JSValue> objects_;
+  std::vector<JSAtom> keys_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_BINDINGS_QJS_STRUCTURED_CLONE_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "structured_clone.h"
+#include <quickjs/quickjs.h>
+#include <string>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+static JSValue RoundTrip(JSContext* ctx, const std::string& code) {
+  JSValue value = JS_Eval(ctx, code.c_str(), code.size(), "vm://", JS_EVAL_TYPE_GLOBAL);
+  StructuredCloneWriter writer(ctx);
+  EXPECT_EQ(writer.Write(value), true);
+  JS_FreeValue(ctx, value);
+  return StructuredCloneReader(ctx, writer.data(), writer.length()).Read();
+}
+
+static std::string Stringify(JSContext* ctx, JSValue value) {
+  JSValue json = JS_JSONStringify(ctx, value, JS_NULL, JS_NULL);
+  const char* str = JS_ToCString(ctx, json);
+  std::string result = str;
+  JS_FreeCString(ctx, str);
+  JS_FreeValue(ctx, json);
+  return result;
+}
+
+TEST(StructuredClone, sameAsJSON) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+
+  JSValue value =
+      RoundTrip(ctx, "({a: 1, b: [1.5, 'x', null, undefined, true], c: {a: -2, d: '\\u4f60\\u597d'}, e: undefined})");
+  EXPECT_STREQ(Stringify(ctx, value).c_str(),
+               "{\"a\":1,\"b\":[1.5,\"x\",null,null,true],\"c\":{\"a\":-2,\"d\":\"你好\"}}");
+  JS_FreeValue(ctx, value);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(StructuredClone, toJSONAndNonFiniteNumbers) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+
+  JSValue value =
+      RoundTrip(ctx, "({d: new Date(0), n: NaN, i: [Infinity, -Infinity], o: {toJSON(key) { return key; }}})");
+  EXPECT_STREQ(Stringify(ctx, value).c_str(),
+               "{\"d\":\"1970-01-01T00:00:00.000Z\",\"n\":null,\"i\":[null,null],\"o\":\"o\"}");
+  JS_FreeValue(ctx, value);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(StructuredClone, int64Limits) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+
+  // INT64_MIN in sleb, the last byte carries the sign bit at shift 63.
+  uint8_t bytes[] = {STRUCTURED_CLONE_VERSION,
+                     static_cast<uint8_t>(StructuredCloneTag::kInt),
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x80,
+                     0x7f};
+  JSValue value = StructuredCloneReader(ctx, bytes, sizeof(bytes)).Read();
+  int64_t result;
+  JS_ToInt64(ctx, &result, value);
+  EXPECT_EQ(result, INT64_MIN);
+  JS_FreeValue(ctx, value);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(StructuredClone, sharedAndCyclicReferences) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+
+  JSValue value = RoundTrip(ctx, "var o = {}; var a = {x: o, y: o}; a.self = a; a");
+  JSValue x = JS_GetPropertyStr(ctx, value, "x");
+  JSValue y = JS_GetPropertyStr(ctx, value, "y");
+  JSValue self = JS_GetPropertyStr(ctx, value, "self");
+  EXPECT_EQ(JS_VALUE_GET_PTR(x), JS_VALUE_GET_PTR(y));
+  EXPECT_EQ(JS_VALUE_GET_PTR(self), JS_VALUE_GET_PTR(value));
+  JS_FreeValue(ctx, x);
+  JS_FreeValue(ctx, y);
+  JS_FreeValue(ctx, self);
+  // Break the cycle before freeing the runtime.
+  JS_SetPropertyStr(ctx, value, "self", JS_NULL);
+  JS_FreeValue(ctx, value);
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
+
+TEST(StructuredClone, malformedData) {
+  JSRuntime* runtime = JS_NewRuntime();
+  JSContext* ctx = JS_NewContext(runtime);
+
+  uint8_t bytes[] = {STRUCTURED_CLONE_VERSION, static_cast<uint8_t>(StructuredCloneTag::kArray), 10};
+  JSValue value = StructuredCloneReader(ctx, bytes, sizeof(bytes)).Read();
+  EXPECT_EQ(JS_IsException(value), true);
+  JS_FreeValue(ctx, JS_GetException(ctx));
+
+  JS_FreeContext(ctx);
+  JS_FreeRuntime(runtime);
+}
@@ -10,6 +10,7 @@
 #include "core/event/event_target.h"
 #include "core/executing_context.h"
 #include "foundation/native_string.h"
+#include "foundation/native_value_arena.h"
 #include "foundation/native_value_converter.h"
 
 namespace mercury {
@@ -39,8 +40,8 @@ BindingObject::~BindingObject() {
   // When a JSObject got finalized by QuickJS GC, we can not guarantee the ExecutingContext are still alive and
   // accessible.
   if (isContextValid(contextId())) {
-    GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kDisposeBindingObject, nullptr, bindingObject(),
-                                                         nullptr, false);
+    GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kDisposeBindingObject, bindingObject(),
+                                                              nullptr, false);
   }
 }
 
@@ -70,15 +71,24 @@ NativeValue BindingObject::InvokeBindingMethod(const AtomicString& method,
                                                const NativeValue* argv,
                                                ExceptionState& exception_state) const {
   if (binding_object_->invoke_bindings_methods_from_native == nullptr) {
-    GetExecutingContext()->FlushIsolateCommand();
+    GetExecutingContext()->FlushIsolateCommand(binding_object_);
     exception_state.ThrowException(GetExecutingContext()->ctx(), ErrorType::InternalError,
                                    "Failed to call dart method: invoke_bindings_methods_from_native not initialized.");
     return Native_NewNull();
   }
 
   NativeValue return_value = Native_NewNull();
-  NativeValue native_method =
-      NativeValueConverter<NativeTypeString>::ToNativeValue(GetExecutingContext()->ctx(), method);
+  // Dart reads the method name without freeing it, one-byte names are borrowed from the atom and the others from the
+  // string cache.
+  NativeValue native_method;
+  CachedNativeString cached_method;
+  if (!method.IsNull() && !JS_AtomIsTaggedInt(method.Impl()) && method.Is8Bit()) {
+    native_method = Native_NewLatin1String(method.Character8(), method.length());
+  } else {
+    cached_method = GetExecutingContext()->dartIsolateContext()->EnsureData()->nativeStringCache()->Get(
+        GetExecutingContext()->ctx(), method);
+    native_method = Native_NewString(const_cast<SharedNativeString*>(cached_method.get()));
+  }
   binding_object_->invoke_bindings_methods_from_native(GetExecutingContext()->contextId(), binding_object_,
                                                        &return_value, &native_method, argc, argv);
   return return_value;
@@ -89,7 +99,7 @@ NativeValue BindingObject::InvokeBindingMethod(BindingMethodCallOperations bindi
                                                const NativeValue* argv,
                                                ExceptionState& exception_state) const {
   if (binding_object_->invoke_bindings_methods_from_native == nullptr) {
-    GetExecutingContext()->FlushIsolateCommand();
+    GetExecutingContext()->FlushIsolateCommand(binding_object_);
     exception_state.ThrowException(GetExecutingContext()->ctx(), ErrorType::InternalError,
                                    "Failed to call dart method: invoke_bindings_methods_from_native not initialized.");
     return Native_NewNull();
@@ -109,7 +119,23 @@ NativeValue BindingObject::GetBindingProperty(const AtomicString& prop, Exceptio
         "Can not get binding property on BindingObject, dart binding object had been disposed");
     return Native_NewNull();
   }
-  const NativeValue argv[] = {Native_NewString(prop.ToNativeString(GetExecutingContext()->ctx()).release())};
+  return GetBindingPropertyWithKey(
+      NativeValueConverter<NativeTypeString>::ToBorrowedNativeValue(GetExecutingContext()->ctx(), prop),
+      exception_state);
+}
+
+NativeValue BindingObject::GetBindingProperty(int32_t property_id, ExceptionState& exception_state) const {
+  if (UNLIKELY(binding_object_->disposed_)) {
+    exception_state.ThrowException(
+        ctx(), ErrorType::InternalError,
+        "Can not get binding property on BindingObject, dart binding object had been disposed");
+    return Native_NewNull();
+  }
+  return GetBindingPropertyWithKey(Native_NewInt64(property_id), exception_state);
+}
+
+NativeValue BindingObject::GetBindingPropertyWithKey(NativeValue key, ExceptionState& exception_state) const {
+  const NativeValue argv[] = {key};
   return InvokeBindingMethod(BindingMethodCallOperations::kGetProperty, 1, argv, exception_state);
 }
 
@@ -122,8 +148,48 @@ NativeValue BindingObject::SetBindingProperty(const AtomicString& prop,
         "Can not set binding property on BindingObject, dart binding object had been disposed");
     return Native_NewNull();
   }
-  GetExecutingContext()->FlushIsolateCommand();
-  const NativeValue argv[] = {Native_NewString(prop.ToNativeString(GetExecutingContext()->ctx()).release()), value};
+  return SetBindingPropertyWithKey(
+      NativeValueConverter<NativeTypeString>::ToBorrowedNativeValue(GetExecutingContext()->ctx(), prop), value,
+      exception_state);
+}
+
+NativeValue BindingObject::SetBindingProperty(int32_t property_id,
+                                              NativeValue value,
+                                              ExceptionState& exception_state) const {
+  if (UNLIKELY(binding_object_->disposed_)) {
+    exception_state.ThrowException(
+        ctx(), ErrorType::InternalError,
+        "Can not set binding property on BindingObject, dart binding object had been disposed");
+    return Native_NewNull();
+  }
+  return SetBindingPropertyWithKey(Native_NewInt64(property_id), value, exception_state);
+}
+
+static bool IsScalarNativeValue(const NativeValue& value) {
+  switch (static_cast<NativeTag>(value.tag)) {
+    case NativeTag::TAG_STRING:
+    case NativeTag::TAG_LATIN1_STRING:
+    case NativeTag::TAG_INT:
+    case NativeTag::TAG_BOOL:
+    case NativeTag::TAG_NULL:
+    case NativeTag::TAG_FLOAT64:
+      return true;
+    default:
+      return false;
+  }
+}
+
+NativeValue BindingObject::SetBindingPropertyWithKey(NativeValue key,
+                                                     NativeValue value,
+                                                     ExceptionState& exception_state) const {
+  // Values which may reference other binding objects, directly or nested in lists, need them to be created at the
+  // dart side first. Only scalars are known to reference nothing.
+  if (IsScalarNativeValue(value)) {
+    GetExecutingContext()->FlushIsolateCommand(binding_object_);
+  } else {
+    GetExecutingContext()->FlushIsolateCommand();
+  }
+  const NativeValue argv[] = {key, value};
   return InvokeBindingMethod(BindingMethodCallOperations::kSetProperty, 2, argv, exception_state);
 }
 
@@ -135,14 +201,20 @@ ScriptValue BindingObject::AnonymousFunctionCallback(JSContext* ctx,
   auto* data = reinterpret_cast<AnonymousFunctionData*>(private_data);
   auto* event_target = toScriptWrappable<EventTarget>(this_val.QJSValue());
 
+  // Arguments are read by dart during the call, and released together with the arena after it returns.
+  NativeValueArena arena;
   std::vector<NativeValue> arguments;
   arguments.reserve(argc + 1);
-  arguments.emplace_back(NativeValueConverter<NativeTypeString>::ToNativeValue(data->method_name));
+  if (data->method_id >= 0) {
+    arguments.emplace_back(Native_NewInt64(data->method_id));
+  } else {
+    arguments.emplace_back(arena.NewCString(data->method_name));
+  }
 
   ExceptionState exception_state;
 
   for (int i = 0; i < argc; i++) {
-    arguments.emplace_back(argv[i].ToNative(ctx, exception_state));
+    arguments.emplace_back(argv[i].ToNative(ctx, &arena, exception_state));
   }
 
   if (exception_state.HasException()) {
@@ -170,6 +242,29 @@ void BindingObject::HandleAnonymousAsyncCalledFromDart(void* ptr,
   if (promise_context->context->contextId() != contextId)
     return;
 
+  SettleAnonymousAsyncPromise(promise_context, native_value, errmsg);
+}
+
+void BindingObject::HandleAnonymousAsyncCompletionsFromDart(ExecutingContext* context,
+                                                            const NativeBindingAsyncCompletion* completions,
+                                                            int32_t count) {
+  if (!context->IsContextValid())
+    return;
+
+  for (int32_t i = 0; i < count; i++) {
+    const NativeBindingAsyncCompletion& completion = completions[i];
+    if (completion.promise_context->context != context)
+      continue;
+    completion.promise_context->promise_resolver->SetDrainPendingJobs(false);
+    SettleAnonymousAsyncPromise(completion.promise_context, completion.value, completion.errmsg);
+  }
+
+  context->DrainPendingPromiseJobs();
+}
+
+void BindingObject::SettleAnonymousAsyncPromise(BindingObjectPromiseContext* promise_context,
+                                                const NativeValue* native_value,
+                                                const char* errmsg) {
   auto* context = promise_context->context;
 
   if (native_value != nullptr) {
@@ -202,10 +297,15 @@ ScriptValue BindingObject::AnonymousAsyncFunctionCallback(JSContext* ctx,
       new BindingObjectPromiseContext{{}, event_target->GetExecutingContext(), event_target, promise_resolver};
   event_target->TrackPendingPromiseBindingContext(promise_context);
 
+  NativeValueArena arena;
   std::vector<NativeValue> arguments;
   arguments.reserve(argc + 4);
 
-  arguments.emplace_back(NativeValueConverter<NativeTypeString>::ToNativeValue(data->method_name));
+  if (data->method_id >= 0) {
+    arguments.emplace_back(Native_NewInt64(data->method_id));
+  } else {
+    arguments.emplace_back(arena.NewCString(data->method_name));
+  }
   arguments.emplace_back(
       NativeValueConverter<NativeTypeInt64>::ToNativeValue(event_target->GetExecutingContext()->contextId()));
   arguments.emplace_back(
@@ -216,7 +316,7 @@ ScriptValue BindingObject::AnonymousAsyncFunctionCallback(JSContext* ctx,
   ExceptionState exception_state;
 
   for (int i = 0; i < argc; i++) {
-    arguments.emplace_back(argv[i].ToNative(ctx, exception_state));
+    arguments.emplace_back(argv[i].ToNative(ctx, &arena, exception_state));
   }
 
   event_target->InvokeBindingMethod(BindingMethodCallOperations::kAsyncAnonymousFunction, argc + 4, arguments.data(),
@@ -231,7 +331,7 @@ ScriptValue BindingObject::AnonymousAsyncFunctionCallback(JSContext* ctx,
 }
 
 NativeValue BindingObject::GetAllBindingPropertyNames(ExceptionState& exception_state) const {
-  GetExecutingContext()->FlushIsolateCommand();
+  GetExecutingContext()->FlushIsolateCommand(binding_object_);
   return InvokeBindingMethod(BindingMethodCallOperations::kGetAllPropertyNames, 0, nullptr, exception_state);
 }
 
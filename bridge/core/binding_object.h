@@ -53,6 +53,8 @@ struct NativeBindingObject : public DartReadable {
   BindingObject* binding_target_{nullptr};
   InvokeBindingMethodsFromDart invoke_binding_methods_from_dart{nullptr};
   InvokeBindingsMethodsFromNative invoke_bindings_methods_from_native{nullptr};
+  // Epoch of the IsolateCommandBuffer flush which has commands referencing this object, see HasPendingCommands.
+  int64_t pending_command_epoch_{0};
 };
 
 enum BindingMethodCallOperations {
@@ -71,10 +73,20 @@ struct BindingObjectPromiseContext : public DartReadable {
   std::shared_ptr<ScriptPromiseResolver> promise_resolver;
 };
 
+// One settled async binding call, filled by the Dart side and handed over in batches.
+struct NativeBindingAsyncCompletion {
+  BindingObjectPromiseContext* promise_context;
+  // Only one of them is set, errmsg for rejected calls and value for resolved calls.
+  NativeValue* value;
+  const char* errmsg;
+};
+
 class BindingObject : public ScriptWrappable {
  public:
   struct AnonymousFunctionData {
     std::string method_name;
+    // Dense id assigned at shape sync time, sent instead of method_name when available.
+    int32_t method_id{-1};
   };
 
   // This function were called when the anonymous function returned to the JS code has been called by users.
@@ -92,6 +104,10 @@ class BindingObject : public ScriptWrappable {
                                                  NativeValue* native_value,
                                                  int32_t contextId,
                                                  const char* errmsg);
+  // Settle a batch of async calls completed at dart side, pending promise jobs are drained once after all of them.
+  static void HandleAnonymousAsyncCompletionsFromDart(ExecutingContext* context,
+                                                      const NativeBindingAsyncCompletion* completions,
+                                                      int32_t count);
 
   BindingObject() = delete;
   ~BindingObject();
@@ -107,8 +123,13 @@ class BindingObject : public ScriptWrappable {
                                   int32_t argc,
                                   const NativeValue* args,
                                   ExceptionState& exception_state) const;
+  // Each read is one call into dart. Reads are not batched: a getter runs dart code which may depend on earlier
+  // setters or method calls, so values can not be fetched ahead of the script asking for them.
   NativeValue GetBindingProperty(const AtomicString& prop, ExceptionState& exception_state) const;
   NativeValue SetBindingProperty(const AtomicString& prop, NativeValue value, ExceptionState& exception_state) const;
+  // Same as above, but address the property by the dense id assigned at shape sync time.
+  NativeValue GetBindingProperty(int32_t property_id, ExceptionState& exception_state) const;
+  NativeValue SetBindingProperty(int32_t property_id, NativeValue value, ExceptionState& exception_state) const;
   NativeValue GetAllBindingPropertyNames(ExceptionState& exception_state) const;
 
   FORCE_INLINE NativeBindingObject* bindingObject() const { return binding_object_; }
@@ -128,6 +149,12 @@ class BindingObject : public ScriptWrappable {
   virtual bool IsCanvasGradient() const;
 
  protected:
+  static void SettleAnonymousAsyncPromise(BindingObjectPromiseContext* promise_context,
+                                          const NativeValue* native_value,
+                                          const char* errmsg);
+  NativeValue GetBindingPropertyWithKey(NativeValue key, ExceptionState& exception_state) const;
+  NativeValue SetBindingPropertyWithKey(NativeValue key, NativeValue value, ExceptionState& exception_state) const;
+
   void TrackPendingPromiseBindingContext(BindingObjectPromiseContext* binding_object_promise_context);
   void FullFillPendingPromise(BindingObjectPromiseContext* binding_object_promise_context);
   NativeValue InvokeBindingMethod(BindingMethodCallOperations binding_method_call_operation,
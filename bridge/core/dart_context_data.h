@@ -8,13 +8,18 @@
 #include <set>
 #include <unordered_map>
 #include "bindings/qjs/atomic_string.h"
+#include "bindings/qjs/native_string_cache.h"
+#include "bindings/qjs/native_typed_array_registry.h"
 
 namespace mercury {
 
+// Maps each name to the dense id assigned at sync time, the id is the index of the name in the list synced from dart.
+using WidgetElementShapeIds = std::unordered_map<AtomicString, int32_t, AtomicString::KeyHasher>;
+
 struct WidgetElementShape {
-  std::set<AtomicString> built_in_properties_;
-  std::set<AtomicString> built_in_methods_;
-  std::set<AtomicString> built_in_async_methods_;
+  WidgetElementShapeIds built_in_properties_;
+  WidgetElementShapeIds built_in_methods_;
+  WidgetElementShapeIds built_in_async_methods_;
 };
 
 class DartContextData {
@@ -22,6 +27,8 @@ class DartContextData {
   const WidgetElementShape* GetWidgetElementShape(const AtomicString& key);
   bool HasWidgetElementShape(const AtomicString& key);
   void SetWidgetElementShape(const AtomicString& key, const std::shared_ptr<WidgetElementShape>& shape);
+  NativeStringCache* nativeStringCache() { return &native_string_cache_; }
+  NativeTypedArrayRegistry* nativeTypedArrays() { return &native_typed_arrays_; }
 
  private:
   // WidgetElements' properties and methods are defined in the dart Side.
@@ -29,6 +36,10 @@ class DartContextData {
   // prop getter and setter and functions for JS code. This map store the properties and methods of WidgetElement which
   // already created.
   std::unordered_map<AtomicString, std::shared_ptr<WidgetElementShape>, AtomicString::KeyHasher> widget_element_shapes_;
+  // Lives as long as the runtime, it's released before the runtime is freed.
+  NativeStringCache native_string_cache_;
+  // Dart views of shared buffers may outlive their context, but not the dart isolate.
+  NativeTypedArrayRegistry native_typed_arrays_;
 };
 
 }  // namespace mercury
@@ -20,6 +20,7 @@ mercury::DartMethodPointer::DartMethodPointer(const uint64_t* dart_methods, int3
 
   onJsError = reinterpret_cast<OnJSError>(dart_methods[i++]);
   onJsLog = reinterpret_cast<OnJSLog>(dart_methods[i++]);
+  requestBatchUpdate = reinterpret_cast<RequestBatchUpdate>(dart_methods[i++]);
 
   assert_m(i == dart_methods_length, "Dart native methods count is not equal with C++ side method registrations.");
 }
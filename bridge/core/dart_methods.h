@@ -32,10 +32,11 @@ using AsyncModuleCallback = NativeValue* (*)(void* callback_context,
                                              NativeValue* value);
 using AsyncBlobCallback =
     void (*)(void* callback_context, int32_t context_id, const char* error, uint8_t* bytes, int32_t length);
+// Module and method names are borrowed from the NativeStringCache, dart must not free them.
 typedef NativeValue* (*InvokeModule)(void* callback_context,
                                      int32_t context_id,
-                                     SharedNativeString* moduleName,
-                                     SharedNativeString* method,
+                                     const SharedNativeString* moduleName,
+                                     const SharedNativeString* method,
                                      NativeValue* params,
                                      AsyncModuleCallback callback);
 typedef void (*RequestBatchUpdate)(int32_t context_id);
@@ -50,16 +50,23 @@ CloseEvent::CloseEvent(ExecutingContext* context,
 CloseEvent::CloseEvent(ExecutingContext* context, const AtomicString& type, NativeCloseEvent* native_close_event)
     : Event(context, type, &native_close_event->native_event),
       code_(native_close_event->code),
-#if ANDROID_32_BIT
-      reason_(AtomicString(
-          context->ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_close_event->reason)))),
-#else
-      reason_(AtomicString(
-          context->ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_close_event->reason)))),
-#endif
-      was_clean_(native_close_event->wasClean) {
+      native_close_event_(native_close_event),
+      reason_pending_(true),
+      was_clean_(native_close_event->wasClean) {}
+
+CloseEvent::~CloseEvent() {
+  if (reason_pending_)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_close_event_->reason);
+}
+
+void CloseEvent::ResetFromRawEvent(RawEvent* raw_event) {
+  if (reason_pending_)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_close_event_->reason);
+  Event::ResetFromRawEvent(raw_event);
+  native_close_event_ = toNativeEvent<NativeCloseEvent>(raw_event);
+  code_ = native_close_event_->code;
+  was_clean_ = native_close_event_->wasClean;
+  reason_pending_ = true;
 }
 
 bool CloseEvent::IsCloseEvent() const {
@@ -71,6 +78,12 @@ int64_t CloseEvent::code() const {
 }
 
 const AtomicString& CloseEvent::reason() const {
+  if (reason_pending_) {
+    reason_ = AtomicString(
+        ctx(),
+        std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_close_event_->reason)));
+    reason_pending_ = false;
+  }
   return reason_;
 }
 
@@ -45,8 +45,10 @@ class CloseEvent : public Event {
                       const std::shared_ptr<CloseEventInit>& initializer,
                       ExceptionState& exception_state);
   explicit CloseEvent(ExecutingContext* context, const AtomicString& type, NativeCloseEvent* raw_event);
+  ~CloseEvent();
 
   bool IsCloseEvent() const override;
+  void ResetFromRawEvent(RawEvent* raw_event) override;
 
   int64_t code() const;
   const AtomicString& reason() const;
@@ -54,7 +56,10 @@ class CloseEvent : public Event {
 
  private:
   int64_t code_;
-  AtomicString reason_;
+  // The reason of events sent from dart is decoded on first access.
+  NativeCloseEvent* native_close_event_{nullptr};
+  mutable bool reason_pending_{false};
+  mutable AtomicString reason_;
   bool was_clean_;
 };
 
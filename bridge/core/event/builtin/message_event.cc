@@ -38,46 +38,62 @@ MessageEvent::MessageEvent(ExecutingContext* context,
                            const AtomicString& type,
                            NativeMessageEvent* native_message_event)
     : Event(context, type, &native_message_event->native_event),
-#if ANDROID_32_BIT
-      data_(ScriptValue(ctx(), *(reinterpret_cast<NativeValue*>(native_message_event->data)))),
-      origin_(AtomicString(ctx(),
-                           std::unique_ptr<AutoFreeNativeString>(
-                               reinterpret_cast<AutoFreeNativeString*>(native_message_event->origin)))),
-      lastEventId_(AtomicString(ctx(),
-                                std::unique_ptr<AutoFreeNativeString>(
-                                    reinterpret_cast<AutoFreeNativeString*>(native_message_event->lastEventId)))),
-      source_(AtomicString(
-          ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_message_event->source))))
-#else
-      data_(ScriptValue(ctx(), *(static_cast<NativeValue*>(native_message_event->data)))),
-      origin_(AtomicString(ctx(),
-                           std::unique_ptr<AutoFreeNativeString>(
-                               reinterpret_cast<AutoFreeNativeString*>(native_message_event->origin)))),
-      lastEventId_(AtomicString(ctx(),
-                                std::unique_ptr<AutoFreeNativeString>(
-                                    reinterpret_cast<AutoFreeNativeString*>(native_message_event->lastEventId)))),
-      source_(AtomicString(
-          ctx(),
-          std::unique_ptr<AutoFreeNativeString>(reinterpret_cast<AutoFreeNativeString*>(native_message_event->source))))
-#endif
-
-{
+      native_message_event_(native_message_event),
+      pending_fields_(kPendingData | kPendingOrigin | kPendingLastEventId | kPendingSource) {}
+
+MessageEvent::~MessageEvent() {
+  ReleasePendingFields();
+}
+
+void MessageEvent::ResetFromRawEvent(RawEvent* raw_event) {
+  ReleasePendingFields();
+  Event::ResetFromRawEvent(raw_event);
+  native_message_event_ = toNativeEvent<NativeMessageEvent>(raw_event);
+  pending_fields_ = kPendingData | kPendingOrigin | kPendingLastEventId | kPendingSource;
+  data_ = ScriptValue::Empty(ctx());
+}
+
+// Free what listeners never read.
+void MessageEvent::ReleasePendingFields() {
+  if (pending_fields_ & kPendingData)
+    ScriptValue::ReleaseNativeValue(*reinterpret_cast<NativeValue*>(native_message_event_->data));
+  if (pending_fields_ & kPendingOrigin)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->origin);
+  if (pending_fields_ & kPendingLastEventId)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->lastEventId);
+  if (pending_fields_ & kPendingSource)
+    delete reinterpret_cast<AutoFreeNativeString*>(native_message_event_->source);
+  pending_fields_ = 0;
+}
+
+void MessageEvent::DecodeString(PendingField field, AtomicString& member, void* native_string) const {
+  member = AtomicString(ctx(), std::unique_ptr<AutoFreeNativeString>(static_cast<AutoFreeNativeString*>(native_string)));
+  pending_fields_ &= ~field;
 }
 
 ScriptValue MessageEvent::data() const {
+  if (pending_fields_ & kPendingData) {
+    data_ = ScriptValue(ctx(), *reinterpret_cast<NativeValue*>(native_message_event_->data));
+    pending_fields_ &= ~kPendingData;
+  }
   return data_;
 }
 
 AtomicString MessageEvent::origin() const {
+  if (pending_fields_ & kPendingOrigin)
+    DecodeString(kPendingOrigin, origin_, reinterpret_cast<void*>(native_message_event_->origin));
   return origin_;
 }
 
 AtomicString MessageEvent::lastEventId() const {
+  if (pending_fields_ & kPendingLastEventId)
+    DecodeString(kPendingLastEventId, lastEventId_, reinterpret_cast<void*>(native_message_event_->lastEventId));
   return lastEventId_;
 }
 
 AtomicString MessageEvent::source() const {
+  if (pending_fields_ & kPendingSource)
+    DecodeString(kPendingSource, source_, reinterpret_cast<void*>(native_message_event_->source));
   return source_;
 }
 
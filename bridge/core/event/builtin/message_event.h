@@ -30,6 +30,7 @@ class MessageEvent : public Event {
                         const AtomicString& type,
                         const std::shared_ptr<MessageEventInit>& init);
   explicit MessageEvent(ExecutingContext* context, const AtomicString& type, NativeMessageEvent* native_message_event);
+  ~MessageEvent();
 
   ScriptValue data() const;
   AtomicString origin() const;
@@ -37,12 +38,25 @@ class MessageEvent : public Event {
   AtomicString source() const;
 
   bool IsMessageEvent() const override;
+  void ResetFromRawEvent(RawEvent* raw_event) override;
 
  private:
-  ScriptValue data_;
-  AtomicString origin_;
-  AtomicString lastEventId_;
-  AtomicString source_;
+  // Members of events sent from dart are decoded from the native event on first access.
+  enum PendingField : uint8_t {
+    kPendingData = 1 << 0,
+    kPendingOrigin = 1 << 1,
+    kPendingLastEventId = 1 << 2,
+    kPendingSource = 1 << 3,
+  };
+  void DecodeString(PendingField field, AtomicString& member, void* native_string) const;
+  void ReleasePendingFields();
+
+  NativeMessageEvent* native_message_event_{nullptr};
+  mutable uint8_t pending_fields_{0};
+  mutable ScriptValue data_;
+  mutable AtomicString origin_;
+  mutable AtomicString lastEventId_;
+  mutable AtomicString source_;
 };
 
 }  // namespace mercury
@@ -30,7 +30,13 @@ CustomEvent::CustomEvent(ExecutingContext* context, const AtomicString& type, Ex
 
 CustomEvent::CustomEvent(ExecutingContext* context, const AtomicString& type, NativeCustomEvent* native_custom_event)
     : Event(context, type, &native_custom_event->native_event),
-      detail_(ScriptValue(ctx(), *native_custom_event->detail)) {}
+      native_custom_event_(native_custom_event),
+      detail_pending_(native_custom_event->detail != nullptr) {}
+
+CustomEvent::~CustomEvent() {
+  if (detail_pending_)
+    ScriptValue::ReleaseNativeValue(*native_custom_event_->detail);
+}
 
 CustomEvent::CustomEvent(ExecutingContext* context,
                          const AtomicString& type,
@@ -38,7 +44,20 @@ CustomEvent::CustomEvent(ExecutingContext* context,
                          ExceptionState& exception_state)
     : Event(context, type), detail_(initialize->detail()) {}
 
+void CustomEvent::ResetFromRawEvent(RawEvent* raw_event) {
+  if (detail_pending_)
+    ScriptValue::ReleaseNativeValue(*native_custom_event_->detail);
+  Event::ResetFromRawEvent(raw_event);
+  native_custom_event_ = toNativeEvent<NativeCustomEvent>(raw_event);
+  detail_pending_ = native_custom_event_->detail != nullptr;
+  detail_ = ScriptValue::Empty(ctx());
+}
+
 ScriptValue CustomEvent::detail() const {
+  if (detail_pending_) {
+    detail_ = ScriptValue(ctx(), *native_custom_event_->detail);
+    detail_pending_ = false;
+  }
   return detail_;
 }
 
@@ -61,6 +80,10 @@ void CustomEvent::initCustomEvent(const AtomicString& type,
                                   ExceptionState& exception_state) {
   initEvent(type, can_bubble, cancelable, exception_state);
   if (!IsBeingDispatched() && !detail.IsEmpty()) {
+    if (detail_pending_) {
+      ScriptValue::ReleaseNativeValue(*native_custom_event_->detail);
+      detail_pending_ = false;
+    }
     detail_ = detail;
   }
 }
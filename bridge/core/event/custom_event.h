@@ -33,6 +33,7 @@ class CustomEvent final : public Event {
   CustomEvent() = delete;
   explicit CustomEvent(ExecutingContext* context, const AtomicString& type, ExceptionState& exception_state);
   explicit CustomEvent(ExecutingContext* context, const AtomicString& type, NativeCustomEvent* native_custom_event);
+  ~CustomEvent();
   explicit CustomEvent(ExecutingContext* context,
                        const AtomicString& type,
                        const std::shared_ptr<CustomEventInit>& initialize,
@@ -50,11 +51,15 @@ class CustomEvent final : public Event {
                        ExceptionState& exception_state);
 
   bool IsCustomEvent() const override;
+  void ResetFromRawEvent(RawEvent* raw_event) override;
 
   void Trace(GCVisitor* visitor) const override;
 
  private:
-  ScriptValue detail_;
+  // The detail of events sent from dart is decoded on first access.
+  NativeCustomEvent* native_custom_event_{nullptr};
+  mutable bool detail_pending_{false};
+  mutable ScriptValue detail_;
 };
 
 template <>
@@ -216,6 +216,11 @@ class Event : public ScriptWrappable {
   bool FireOnlyCaptureListenersAtTarget() const { return fire_only_capture_listeners_at_target_; }
   bool FireOnlyNonCaptureListenersAtTarget() const { return fire_only_non_capture_listeners_at_target_; }
 
+  // Used by EventPool. Reset a recycled event to the state of a new event created from |raw_event| with the same
+  // type, and drop the references a pooled event would otherwise keep alive.
+  virtual void ResetFromRawEvent(RawEvent* raw_event);
+  void ClearTargets();
+
   void Trace(GCVisitor* visitor) const override;
 
  protected:
@@ -62,7 +62,7 @@ bool EventListenerMap::Contains(const AtomicString& event_type) const {
 bool EventListenerMap::ContainsCapturing(const AtomicString& event_type) const {
   for (const auto& entry : entries_) {
     if (entry.first == event_type) {
-      for (const auto& event_listener : *entry.second) {
+      for (const auto& event_listener : entry.second) {
         if (event_listener.Capture())
           return true;
       }
@@ -81,14 +81,13 @@ bool EventListenerMap::Add(const AtomicString& event_type,
                            const std::shared_ptr<AddEventListenerOptions>& options,
                            RegisteredEventListener* registered_event_listener,
                            uint32_t* listener_count) {
-  for (const auto& entry : entries_) {
+  for (auto& entry : entries_) {
     if (entry.first == event_type)
-      return AddListenerToVector(entry.second.get(), listener, options, registered_event_listener, listener_count);
+      return AddListenerToVector(&entry.second, listener, options, registered_event_listener, listener_count);
   }
 
-  entries_.emplace_back(event_type, std::make_unique<EventListenerVector>());
-  return AddListenerToVector(entries_.back().second.get(), listener, options, registered_event_listener,
-                             listener_count);
+  entries_.emplace_back(event_type, EventListenerVector());
+  return AddListenerToVector(&entries_.back().second, listener, options, registered_event_listener, listener_count);
 }
 
 bool EventListenerMap::Remove(const AtomicString& event_type,
@@ -99,9 +98,9 @@ bool EventListenerMap::Remove(const AtomicString& event_type,
                               uint32_t* listener_count) {
   for (unsigned i = 0; i < entries_.size(); ++i) {
     if (entries_[i].first == event_type) {
-      bool was_removed = RemoveListenerFromVector(entries_[i].second.get(), listener, options,
-                                                  index_of_removed_listener, registered_event_listener, listener_count);
-      if (entries_[i].second->empty()) {
+      bool was_removed = RemoveListenerFromVector(&entries_[i].second, listener, options, index_of_removed_listener,
+                                                  registered_event_listener, listener_count);
+      if (entries_[i].second.empty()) {
         entries_.erase(entries_.begin() + i);
       }
       return was_removed;
@@ -112,9 +111,9 @@ bool EventListenerMap::Remove(const AtomicString& event_type,
 }
 
 EventListenerVector* EventListenerMap::Find(const AtomicString& event_type) const {
-  for (const auto& entry : entries_) {
+  for (auto& entry : entries_) {
     if (entry.first == event_type)
-      return entry.second.get();
+      return &entry.second;
   }
 
   return nullptr;
@@ -122,7 +121,7 @@ EventListenerVector* EventListenerMap::Find(const AtomicString& event_type) cons
 
 void EventListenerMap::Trace(GCVisitor* visitor) const {
   for (const auto& entry : entries_) {
-    for (auto& listener : *entry.second) {
+    for (auto& listener : entry.second) {
       listener.Trace(visitor);
     }
   }
@@ -7,11 +7,10 @@
 
 #include <quickjs/quickjs.h>
 
-#include <vector>
-
 #include "bindings/qjs/atomic_string.h"
 #include "event_listener.h"
 #include "foundation/macros.h"
+#include "foundation/small_vector.h"
 #include "registered_eventListener.h"
 
 namespace mercury {
@@ -19,7 +18,8 @@ namespace mercury {
 class AddEventListenerOptions;
 class EventListenerOptions;
 
-using EventListenerVector = std::vector<RegisteredEventListener>;
+// Most targets have one or two listeners per event type.
+using EventListenerVector = SmallVector<RegisteredEventListener, 2>;
 
 class EventListenerMap final {
   MERCURY_DISALLOW_NEW();
@@ -44,6 +44,7 @@ class EventListenerMap final {
               size_t* index_of_removed_listener,
               RegisteredEventListener* registered_event_listener,
               uint32_t* listener_count);
+  // The vector lives inside the map, adding listeners for another event type may move it.
   EventListenerVector* Find(const AtomicString& event_type) const;
 
   void Trace(GCVisitor* visitor) const;
@@ -54,7 +55,8 @@ class EventListenerMap final {
   //  - vector is much more space efficient than hashMap.
   //  - An EventTarget rarely has event listeners for many event types, and
   //    vector is faster in such cases.
-  std::vector<std::pair<AtomicString, std::unique_ptr<EventListenerVector>>> entries_;
+  // The first event types and their listeners are stored inline, so the common target needs no heap allocation here.
+  mutable SmallVector<std::pair<AtomicString, EventListenerVector>, 2> entries_;
 };
 
 }  // namespace mercury
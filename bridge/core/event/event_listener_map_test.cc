@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include <chrono>
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+
+namespace mercury {
+
+// Timings are recorded as test properties, see --gtest_output=xml.
+static void RunTimed(ExecutingContext* context, const char* name, const std::string& code) {
+  auto start = std::chrono::steady_clock::now();
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  ::testing::Test::RecordProperty(name, static_cast<int>(elapsed.count()));
+}
+
+TEST(EventListenerMap, listenersOfOtherTypesAddedDuringDispatch) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "3");
+    logCalled = true;
+  };
+  auto context = env->page()->GetExecutingContext();
+
+  // The first listener adds event types until the inline storage is moved to the heap.
+  std::string code = R"(
+let target = new EventTarget();
+let count = 0;
+target.addEventListener('a', () => {
+  count++;
+  for (let i = 0; i < 8; i++) target.addEventListener('b' + i, () => {});
+});
+target.addEventListener('a', () => count++);
+target.addEventListener('a', () => count++);
+target.dispatchEvent(new Event('a'));
+console.log(count);
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+// Not part of the default run, use --gtest_also_run_disabled_tests --gtest_filter=EventListenerMap.*benchmark.
+TEST(EventListenerMap, DISABLED_benchmark) {
+  bool static errorCalled = false;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {};
+  auto context = env->page()->GetExecutingContext();
+
+  RunTimed(context, "add_remove_x100000_us", R"(
+let target = new EventTarget();
+let listener = () => {};
+for (let i = 0; i < 100000; i++) {
+  target.addEventListener('click', listener);
+  target.removeEventListener('click', listener);
+}
+)");
+
+  RunTimed(context, "create_targets_x10000_us", R"(
+let targets = [];
+for (let i = 0; i < 10000; i++) {
+  let target = new EventTarget();
+  target.addEventListener('click', () => {});
+  target.addEventListener('change', () => {});
+  targets.push(target);
+}
+)");
+
+  RunTimed(context, "dispatch_x100000_us", R"(
+let dispatchTarget = new EventTarget();
+dispatchTarget.addEventListener('click', () => {});
+let event = new Event('click');
+for (let i = 0; i < 100000; i++) {
+  dispatchTarget.dispatchEvent(event);
+}
+)");
+
+  EXPECT_EQ(errorCalled, false);
+}
+
+}  // namespace mercury
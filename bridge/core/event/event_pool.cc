@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "event_pool.h"
+#include "event.h"
+
+namespace mercury {
+
+Event* EventPool::Acquire(const AtomicString& type, RawEvent* raw_event) {
+  auto it = events_.find(type);
+  if (it == events_.end())
+    return nullptr;
+
+  std::vector<PooledEvent>& events = it->second;
+  for (size_t i = events.size(); i > 0; i--) {
+    const PooledEvent& pooled = events[i - 1];
+    if (pooled.raw_event_length != raw_event->length || pooled.is_custom_event != raw_event->is_custom_event)
+      continue;
+    Event* event = pooled.event;
+    events.erase(events.begin() + static_cast<std::ptrdiff_t>(i - 1));
+    event->ResetFromRawEvent(raw_event);
+    return event;
+  }
+  return nullptr;
+}
+
+void EventPool::Release(Event* event, const AtomicString& type, RawEvent* raw_event, bool acquired) {
+  JSValue object = event->ToQuickJSUnsafe();
+  bool retained = static_cast<JSRefCountHeader*>(JS_VALUE_GET_PTR(object))->ref_count > 1;
+  std::vector<PooledEvent>& events = events_[type];
+
+  if (retained || events.size() >= kMaxEventsPerType) {
+    // Escaped events are left to the GC, drop the pool's reference.
+    if (acquired)
+      JS_FreeValueRT(event->runtime(), object);
+    return;
+  }
+
+  // The creation reference is released by the mutation scope, so keep one for the pool.
+  if (!acquired)
+    JS_DupValueRT(event->runtime(), object);
+  event->ClearTargets();
+  events.push_back(PooledEvent{event, raw_event->length, raw_event->is_custom_event});
+}
+
+void EventPool::Clear() {
+  for (auto& entry : events_) {
+    for (auto& pooled : entry.second) {
+      JS_FreeValueRT(pooled.event->runtime(), pooled.event->ToQuickJSUnsafe());
+    }
+  }
+  events_.clear();
+}
+
+size_t EventPool::size() const {
+  size_t size = 0;
+  for (auto& entry : events_) {
+    size += entry.second.size();
+  }
+  return size;
+}
+
+}  // namespace mercury
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_CORE_EVENT_EVENT_POOL_H_
+#define BRIDGE_CORE_EVENT_EVENT_POOL_H_
+
+#include <unordered_map>
+#include <vector>
+#include "bindings/qjs/atomic_string.h"
+
+namespace mercury {
+
+class Event;
+struct RawEvent;
+
+// Opt-in recycling of the Event wrappers of events dispatched from dart. High rate sources whose listeners never keep
+// the event, such as message streams, reuse a few wrappers per type instead of allocating a new Event and QuickJS
+// object for every dispatch. An event is only recycled when nothing but the dispatcher references its QuickJS object
+// after listeners return. Identities held weakly, such as WeakMap keys, can not be detected.
+class EventPool {
+ public:
+  EventPool() = default;
+
+  // Return a pooled event created for the same type and native event layout, reset to the state of |raw_event|.
+  // The caller takes over the reference held by the pool and hands it back with Release().
+  Event* Acquire(const AtomicString& type, RawEvent* raw_event);
+  // Called after dispatch while the caller holds one reference, the pool's if |acquired|, the creation one otherwise.
+  // The event goes back to the pool if listeners did not retain it.
+  void Release(Event* event, const AtomicString& type, RawEvent* raw_event, bool acquired);
+  // Drop all pooled events, must be called before the JSContext is freed.
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  static constexpr size_t kMaxEventsPerType = 8;
+
+  struct PooledEvent {
+    Event* event;
+    // Events of the same type only share a class when they come with the same layout.
+    int64_t raw_event_length;
+    int8_t is_custom_event;
+  };
+
+  std::unordered_map<AtomicString, std::vector<PooledEvent>, AtomicString::KeyHasher> events_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_CORE_EVENT_EVENT_POOL_H_
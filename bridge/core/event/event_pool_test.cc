@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "event_pool.h"
+#include <memory>
+#include <vector>
+#include "event_target.h"
+#include "gtest/gtest.h"
+#include "mercury_test_env.h"
+#include "qjs_message_event.h"
+
+namespace mercury {
+
+// A message event as dart sends it in a batch, the data is left unread unless a listener asks for it. Events keep
+// pointing to these bytes, so they must outlive the test env.
+struct TestMessageEvent {
+  TestMessageEvent(EventTarget* target, const std::string& data) : data_value(Native_NewCString(data)) {
+    native_event.native_event.target = target->bindingObject();
+    native_event.native_event.currentTarget = target->bindingObject();
+    native_event.data = reinterpret_cast<decltype(native_event.data)>(&data_value);
+    raw_event.bytes = reinterpret_cast<uint64_t*>(&native_event);
+    raw_event.length = sizeof(NativeMessageEvent) / sizeof(int64_t);
+    raw_event.is_custom_event = 0;
+  }
+
+  NativeValue data_value;
+  NativeMessageEvent native_event{};
+  RawEvent raw_event;
+};
+
+static EventTarget* GetTarget(ExecutingContext* context) {
+  JSValue global = JS_GetGlobalObject(context->ctx());
+  JSValue value = JS_GetPropertyStr(context->ctx(), global, "target");
+  auto* target = toScriptWrappable<EventTarget>(value);
+  JS_FreeValue(context->ctx(), value);
+  JS_FreeValue(context->ctx(), global);
+  return target;
+}
+
+using TestMessageEvents = std::vector<std::unique_ptr<TestMessageEvent>>;
+
+static void DispatchRecycled(ExecutingContext* context,
+                             EventTarget* target,
+                             const std::string& data,
+                             TestMessageEvents& events) {
+  events.push_back(std::make_unique<TestMessageEvent>(target, data));
+  SharedNativeString* type = stringToNativeString("message").release();
+  NativeEventDispatch dispatch{target->bindingObject(), type, &events.back()->raw_event, 0, 1};
+  EventDispatchResult result;
+  EventTarget::HandleDispatchEventsFromDart(context, &dispatch, 1, &result);
+  delete type;
+}
+
+TEST(EventPool, retainedEventIsNotRecycled) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  TestMessageEvents events;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "2 true");
+    logCalled = true;
+  };
+  auto context = env->page()->GetExecutingContext();
+
+  std::string code = R"(
+globalThis.target = new EventTarget();
+globalThis.kept = [];
+target.addEventListener('message', (e) => kept.push(e));
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+  EventTarget* target = GetTarget(context);
+
+  DispatchRecycled(context, target, "a", events);
+  EXPECT_EQ(context->eventPool()->size(), 0);
+  DispatchRecycled(context, target, "b", events);
+  EXPECT_EQ(context->eventPool()->size(), 0);
+
+  std::string check = "console.log(kept.length + ' ' + (kept[0] !== kept[1]));";
+  context->EvaluateJavaScript(check.c_str(), check.size(), "vm://", 0);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+TEST(EventPool, recycledMessageEventIsReset) {
+  bool static errorCalled = false;
+  bool static logCalled = false;
+  TestMessageEvents events;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {
+    EXPECT_STREQ(message.c_str(), "b");
+    logCalled = true;
+  };
+  auto context = env->page()->GetExecutingContext();
+
+  // The first event is pooled with its data unread, the recycled wrapper must not serve it again.
+  std::string code = R"(
+globalThis.target = new EventTarget();
+let count = 0;
+target.addEventListener('message', (e) => {
+  if (count++ == 1) console.log(e.data);
+});
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+  EventTarget* target = GetTarget(context);
+
+  DispatchRecycled(context, target, "a", events);
+  EXPECT_EQ(context->eventPool()->size(), 1);
+  DispatchRecycled(context, target, "b", events);
+  EXPECT_EQ(context->eventPool()->size(), 1);
+
+  EXPECT_EQ(errorCalled, false);
+  EXPECT_EQ(logCalled, true);
+}
+
+TEST(EventPool, clear) {
+  bool static errorCalled = false;
+  TestMessageEvents events;
+  auto env = TEST_init([](int32_t contextId, const char* errmsg) { errorCalled = true; });
+  mercury::MercuryMain::consoleMessageHandler = [](void* ctx, const std::string& message, int logLevel) {};
+  auto context = env->page()->GetExecutingContext();
+
+  std::string code = R"(
+globalThis.target = new EventTarget();
+target.addEventListener('message', () => {});
+)";
+  context->EvaluateJavaScript(code.c_str(), code.size(), "vm://", 0);
+  EventTarget* target = GetTarget(context);
+
+  DispatchRecycled(context, target, "a", events);
+  EXPECT_EQ(context->eventPool()->size(), 1);
+  context->eventPool()->Clear();
+  EXPECT_EQ(context->eventPool()->size(), 0);
+
+  // Pooled events are dropped again when the context is disposed, before the runtime checks for leaked objects.
+  DispatchRecycled(context, target, "b", events);
+  EXPECT_EQ(context->eventPool()->size(), 1);
+
+  EXPECT_EQ(errorCalled, false);
+}
+
+}  // namespace mercury
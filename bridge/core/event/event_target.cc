@@ -23,20 +23,6 @@
 
 namespace mercury {
 
-struct EventDispatchResult : public DartReadable {
-  bool canceled{false};
-  bool propagationStopped{false};
-};
-
-struct DartEventListenerOptions : public DartReadable {
-  bool capture{false};
-};
-
-struct DartAddEventListenerOptions : public DartEventListenerOptions {
-  bool passive{false};
-  bool once{false};
-};
-
 Event::PassiveMode EventPassiveMode(const RegisteredEventListener& event_listener) {
   if (!event_listener.Passive()) {
     return Event::PassiveMode::kNotPassiveDefault;
@@ -71,8 +57,8 @@ EventTarget::~EventTarget() {
 
 EventTarget::EventTarget(ExecutingContext* context, const AtomicString& constructor_name)
     : className_(constructor_name), BindingObject(context->ctx()) {
-  GetExecutingContext()->isolateCommandBuffer()->addCommand(
-      IsolateCommand::kCreateEventTarget, std::move(constructor_name.ToNativeString(ctx())), bindingObject(), nullptr);
+  GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kCreateEventTarget, constructor_name,
+                                                            bindingObject(), nullptr);
 }
 
 EventTarget::EventTarget(ExecutingContext* context, NativeBindingObject* native_binding_object)
@@ -177,12 +163,7 @@ DispatchEventResult EventTarget::FireEventListeners(Event& event, ExceptionState
   if (!d)
     return DispatchEventResult::kNotCanceled;
 
-  EventListenerVector* listeners_vector = d->event_listener_map.Find(event.type());
-
-  bool fired_event_listeners = false;
-  if (listeners_vector) {
-    fired_event_listeners = FireEventListeners(event, d, *listeners_vector, exception_state);
-  }
+  bool fired_event_listeners = FireEventListeners(event, d, d->event_listener_map, exception_state);
 
   // Only invoke the callback if event listeners were fired for this phase.
   if (fired_event_listeners) {
@@ -198,16 +179,8 @@ DispatchEventResult EventTarget::FireEventListeners(Event& event, bool isCapture
   if (!d)
     return DispatchEventResult::kNotCanceled;
 
-  EventListenerVector* listeners_vector;
-  if (!isCapture)
-    listeners_vector = d->event_listener_map.Find(event.type());
-  else
-    listeners_vector = d->event_capture_listener_map.Find(event.type());
-
-  bool fired_event_listeners = false;
-  if (listeners_vector) {
-    fired_event_listeners = FireEventListeners(event, d, *listeners_vector, exception_state);
-  }
+  EventListenerMap& listener_map = isCapture ? d->event_capture_listener_map : d->event_listener_map;
+  bool fired_event_listeners = FireEventListeners(event, d, listener_map, exception_state);
 
   // Only invoke the callback if event listeners were fired for this phase.
   if (fired_event_listeners) {
@@ -302,8 +275,12 @@ bool EventTarget::AddEventListenerInternal(const AtomicString& event_type,
       listener_options->passive = options->passive();
     }
 
-    GetExecutingContext()->isolateCommandBuffer()->addCommand(
-        IsolateCommand::kAddEvent, std::move(event_type.ToNativeString(ctx())), bindingObject(), listener_options);
+    GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kAddEvent, event_type, bindingObject(),
+                                                              listener_options);
+  }
+
+  if (added) {
+    SendEventListenerSummary(event_type);
   }
 
   return added;
@@ -350,11 +327,12 @@ bool EventTarget::RemoveEventListenerInternal(const AtomicString& event_type,
   if (listener_count == 0) {
     bool has_capture = options->hasCapture() && options->capture();
 
-    GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kRemoveEvent,
-                                                         std::move(event_type.ToNativeString(ctx())), bindingObject(),
-                                                         has_capture ? (void*)0x01 : nullptr);
+    GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kRemoveEvent, event_type, bindingObject(),
+                                                              has_capture ? (void*)0x01 : nullptr);
   }
 
+  SendEventListenerSummary(event_type);
+
   return true;
 }
 
@@ -396,11 +374,7 @@ NativeValue EventTarget::HandleDispatchEventFromDart(int32_t argc, const NativeV
   Event* event = EventFactory::Create(GetExecutingContext(), event_type, raw_event);
   assert(event->target() != nullptr);
   assert(event->currentTarget() != nullptr);
-  ExceptionState exception_state;
-  event->SetTrusted(false);
-  event->SetEventPhase(Event::kAtTarget);
-  DispatchEventResult dispatch_result = FireEventListeners(*event, isCapture, exception_state);
-  event->SetEventPhase(0);
+  DispatchEventResult dispatch_result = FireEventFromDart(*event, isCapture);
 
   auto* wire = new DartWireContext();
   wire->jsObject = event->ToValue();
@@ -416,15 +390,65 @@ NativeValue EventTarget::HandleDispatchEventFromDart(int32_t argc, const NativeV
   Dart_NewFinalizableHandle_DL(dart_object, reinterpret_cast<void*>(wire), sizeof(DartWireContext),
                                dart_object_finalize_callback);
 
+  auto* result = new EventDispatchResult{.canceled = dispatch_result == DispatchEventResult::kCanceledByEventHandler,
+                                         .propagationStopped = event->propagationStopped()};
+  return NativeValueConverter<NativeTypePointer<EventDispatchResult>>::ToNativeValue(result);
+}
+
+DispatchEventResult EventTarget::FireEventFromDart(Event& event, bool is_capture) {
+  ExceptionState exception_state;
+  event.SetTrusted(false);
+  event.SetEventPhase(Event::kAtTarget);
+  DispatchEventResult dispatch_result = FireEventListeners(event, is_capture, exception_state);
+  event.SetEventPhase(0);
+
   if (exception_state.HasException()) {
     JSValue error = JS_GetException(ctx());
     GetExecutingContext()->ReportError(error);
     JS_FreeValue(ctx(), error);
   }
 
-  auto* result = new EventDispatchResult{.canceled = dispatch_result == DispatchEventResult::kCanceledByEventHandler,
-                                         .propagationStopped = event->propagationStopped()};
-  return NativeValueConverter<NativeTypePointer<EventDispatchResult>>::ToNativeValue(result);
+  return dispatch_result;
+}
+
+void EventTarget::HandleDispatchEventsFromDart(ExecutingContext* context,
+                                               const NativeEventDispatch* dispatches,
+                                               int32_t count,
+                                               EventDispatchResult* results) {
+  if (!context->IsContextValid())
+    return;
+
+  MemberMutationScope mutation_scope{context};
+  // Batches are mostly made of one event type, so the atom is only rebuilt when the type string changes.
+  const SharedNativeString* last_type = nullptr;
+  AtomicString event_type;
+
+  for (int32_t i = 0; i < count; i++) {
+    const NativeEventDispatch& dispatch = dispatches[i];
+    results[i] = EventDispatchResult();
+    if (dispatch.target == nullptr || dispatch.target->disposed_)
+      continue;
+    auto* target = DynamicTo<EventTarget>(BindingObject::From(dispatch.target));
+    if (target == nullptr || target->GetExecutingContext() != context)
+      continue;
+
+    if (dispatch.type != last_type) {
+      event_type = AtomicString(context->ctx(), dispatch.type->string(), dispatch.type->length());
+      last_type = dispatch.type;
+    }
+
+    Event* event = dispatch.recycle ? context->eventPool()->Acquire(event_type, dispatch.raw_event) : nullptr;
+    bool acquired = event != nullptr;
+    if (!acquired) {
+      event = EventFactory::Create(context, event_type, dispatch.raw_event);
+    }
+    DispatchEventResult dispatch_result = target->FireEventFromDart(*event, dispatch.is_capture != 0);
+    results[i].canceled = dispatch_result == DispatchEventResult::kCanceledByEventHandler;
+    results[i].propagationStopped = event->propagationStopped();
+    if (dispatch.recycle) {
+      context->eventPool()->Release(event, event_type, dispatch.raw_event, acquired);
+    }
+  }
 }
 
 RegisteredEventListener* EventTarget::GetAttributeRegisteredEventListener(const AtomicString& event_type) {
@@ -440,10 +464,41 @@ RegisteredEventListener* EventTarget::GetAttributeRegisteredEventListener(const
   return nullptr;
 }
 
+EventListenerSummary EventTarget::GetEventListenerSummary(const AtomicString& event_type) {
+  EventListenerSummary summary;
+  EventTargetData* d = GetEventTargetData();
+  if (!d)
+    return summary;
+
+  for (EventListenerMap* listener_map : {&d->event_listener_map, &d->event_capture_listener_map}) {
+    EventListenerVector* listeners = listener_map->Find(event_type);
+    if (!listeners)
+      continue;
+    summary.listener_count += listeners->size();
+    for (const auto& registered_listener : *listeners) {
+      summary.has_non_passive |= !registered_listener.Passive();
+      summary.has_capture |= registered_listener.Capture();
+    }
+  }
+  return summary;
+}
+
+void EventTarget::SendEventListenerSummary(const AtomicString& event_type) {
+  // Each add or remove changes the listener count, so the summary of this type always needs an update. Updates within
+  // one flush are coalesced by the command buffer.
+  int64_t packed_summary = GetEventListenerSummary(event_type).Pack();
+  GetExecutingContext()->isolateCommandBuffer()->addCommand(IsolateCommand::kUpdateEventListenerSummary, event_type,
+                                                            bindingObject(), reinterpret_cast<void*>(packed_summary));
+}
+
 bool EventTarget::FireEventListeners(Event& event,
                                      EventTargetData* d,
-                                     EventListenerVector& entry,
+                                     EventListenerMap& listener_map,
                                      ExceptionState& exception_state) {
+  EventListenerVector* entry = listener_map.Find(event.type());
+  if (!entry)
+    return false;
+
   // Fire all listeners registered for this event. Don't fire listeners removed
   // during event dispatch. Also, don't fire event listeners added during event
   // dispatch. Conveniently, all new event listeners will be added after or at
@@ -454,7 +509,7 @@ bool EventTarget::FireEventListeners(Event& event,
     return false;
 
   size_t i = 0;
-  size_t size = entry.size();
+  size_t size = entry->size();
   if (!d->firing_event_iterators)
     d->firing_event_iterators = std::make_unique<FiringEventIteratorVector>();
   d->firing_event_iterators->push_back(FiringEventIterator(event.type(), i, size));
@@ -467,7 +522,12 @@ bool EventTarget::FireEventListeners(Event& event,
     if (event.ImmediatePropagationStopped())
       break;
 
-    RegisteredEventListener registered_listener = entry[i];
+    // Listeners may add or remove listeners of other event types, which moves the inline listener vectors, so look it
+    // up again instead of holding on to it across invocations.
+    entry = listener_map.Find(event.type());
+    if (!entry)
+      break;
+    RegisteredEventListener registered_listener = (*entry)[i];
 
     // Move the iterator past this event listener. This must match
     // the handling of the FiringEventIterator::iterator in
@@ -524,37 +584,46 @@ ScriptValue EventTarget::item(const AtomicString& key, ExceptionState& exception
     return unimplemented_properties_[key];
   }
 
+  // The shape is synced when the dart object is created, so flush only while commands of this object are pending.
   if (!GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(className())) {
-    GetExecutingContext()->FlushIsolateCommand();
+    GetExecutingContext()->FlushIsolateCommand(bindingObject());
+  }
+
+  // Dart defined members are served by the accessors on the shape prototype once this object is linked to it.
+  if (LinkShapePrototype()) {
+    return ScriptValue::Undefined(ctx());
   }
 
   if (key == built_in_string::kSymbol_toStringTag) {
-    return ScriptValue(ctx(), className().ToNativeString(ctx()).release());
+    return ScriptValue(ctx(), className());
   }
 
   auto shape = GetExecutingContext()->dartIsolateContext()->EnsureData()->GetWidgetElementShape(className());
   if (shape != nullptr) {
-    if (shape->built_in_properties_.find(key) != shape->built_in_properties_.end()) {
-      return ScriptValue(ctx(), GetBindingProperty(key, exception_state));
+    auto property = shape->built_in_properties_.find(key);
+    if (property != shape->built_in_properties_.end()) {
+      return ScriptValue(ctx(), GetBindingProperty(property->second, exception_state));
     }
 
-    if (shape->built_in_methods_.find(key) != shape->built_in_methods_.end()) {
+    auto method = shape->built_in_methods_.find(key);
+    if (method != shape->built_in_methods_.end()) {
       if (cached_methods_.count(key) > 0) {
         return cached_methods_[key];
       }
 
-      auto func = CreateSyncMethodFunc(key);
+      auto func = CreateSyncMethodFunc(key, method->second);
       cached_methods_[key] = func;
       return func;
     }
 
-    if (shape->built_in_async_methods_.find(key) != shape->built_in_async_methods_.end()) {
+    auto async_method = shape->built_in_async_methods_.find(key);
+    if (async_method != shape->built_in_async_methods_.end()) {
       if (async_cached_methods_.count(key) > 0) {
         return async_cached_methods_[key];
       }
 
-      auto func = CreateAsyncMethodFunc(key);
-      async_cached_methods_[key] = CreateAsyncMethodFunc(key);
+      auto func = CreateAsyncMethodFunc(key, async_method->second);
+      async_cached_methods_[key] = func;
       return func;
     }
   }
@@ -563,15 +632,33 @@ ScriptValue EventTarget::item(const AtomicString& key, ExceptionState& exception
 }
 
 bool EventTarget::SetItem(const AtomicString& key, const ScriptValue& value, ExceptionState& exception_state) {
+  // The shape is synced when the dart object is created, so flush only while commands of this object are pending.
   if (!GetExecutingContext()->dartIsolateContext()->EnsureData()->HasWidgetElementShape(className())) {
-    GetExecutingContext()->FlushIsolateCommand();
+    GetExecutingContext()->FlushIsolateCommand(bindingObject());
+  }
+
+  if (LinkShapePrototype()) {
+    // Let the setters on the prototype chain handle known properties, others become own properties.
+    JSValue prototype_object = JS_GetPrototype(ctx(), ToQuickJSUnsafe());
+    bool has_property = JS_HasProperty(ctx(), prototype_object, key.Impl());
+    JS_FreeValue(ctx(), prototype_object);
+    if (has_property) {
+      return false;
+    }
+
+    JS_DefinePropertyValue(ctx(), ToQuickJSUnsafe(), key.Impl(), JS_DupValue(ctx(), value.QJSValue()), JS_PROP_C_W_E);
+    return true;
   }
 
   auto shape = GetExecutingContext()->dartIsolateContext()->EnsureData()->GetWidgetElementShape(className());
   // This property is defined in the Dart side
-  if (shape != nullptr && shape->built_in_properties_.count(key) > 0) {
-    NativeValue result = SetBindingProperty(key, value.ToNative(ctx(), exception_state), exception_state);
-    return NativeValueConverter<NativeTypeBool>::FromNativeValue(result);
+  if (shape != nullptr) {
+    auto property = shape->built_in_properties_.find(key);
+    if (property != shape->built_in_properties_.end()) {
+      NativeValue result =
+          SetBindingProperty(property->second, value.ToNative(ctx(), exception_state), exception_state);
+      return NativeValueConverter<NativeTypeBool>::FromNativeValue(result);
+    }
   }
 
   // This property is defined in WidgetElement.prototype, should return false to let it handled in the prototype
@@ -601,33 +688,175 @@ NativeValue EventTarget::HandleSyncPropertiesAndMethodsFromDart(int32_t argc, co
   auto&& sync_methods = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[1]);
   auto&& async_methods = NativeValueConverter<NativeTypeArray<NativeTypeString>>::FromNativeValue(ctx(), argv[2]);
 
-  for (auto& property : properties) {
-    shape->built_in_properties_.emplace(property);
+  // Ids follow the order of the synced lists, dart side derives the same ids from its own ordered tables.
+  for (int32_t i = 0; i < properties.size(); i++) {
+    shape->built_in_properties_.emplace(properties[i], i);
   }
 
-  for (auto& method : sync_methods) {
-    shape->built_in_methods_.emplace(method);
+  for (int32_t i = 0; i < sync_methods.size(); i++) {
+    shape->built_in_methods_.emplace(sync_methods[i], i);
   }
 
-  for (auto& method : async_methods) {
-    shape->built_in_async_methods_.emplace(method);
+  for (int32_t i = 0; i < async_methods.size(); i++) {
+    shape->built_in_async_methods_.emplace(async_methods[i], i);
   }
 
   GetExecutingContext()->dartIsolateContext()->EnsureData()->SetWidgetElementShape(key, shape);
 
+  // Build the prototype of the class on top of this object's prototype, later wrappers of the class are created on it.
+  LinkShapePrototype();
+
   return Native_NewBool(true);
 }
 
-ScriptValue EventTarget::CreateSyncMethodFunc(const AtomicString& method_name) {
+void EventTarget::InitializeQuickJSObject() {
+  ScriptWrappable::InitializeQuickJSObject();
+  LinkShapePrototype();
+}
+
+JSValue EventTarget::InitialPrototype() {
+  if (UsesShapePrototype()) {
+    JSValue prototype = GetExecutingContext()->contextData()->prototypeForShape(className());
+    if (!JS_IsNull(prototype)) {
+      return prototype;
+    }
+  }
+  return ScriptWrappable::InitialPrototype();
+}
+
+bool EventTarget::UsesShapePrototype() const {
+  // Only plain event targets resolve dart members through item(), other interfaces have their own members.
+  return GetWrapperTypeInfo() == EventTarget::GetStaticWrapperTypeInfo();
+}
+
+static bool IsSameObject(JSValueConst a, JSValueConst b) {
+  return JS_IsObject(a) && JS_IsObject(b) && JS_VALUE_GET_PTR(a) == JS_VALUE_GET_PTR(b);
+}
+
+bool EventTarget::LinkShapePrototype() {
+  if (shape_prototype_linked_)
+    return true;
+  if (!UsesShapePrototype())
+    return false;
+
+  auto shape = GetExecutingContext()->dartIsolateContext()->EnsureData()->GetWidgetElementShape(className());
+  if (shape == nullptr)
+    return false;
+
+  auto* context_data = GetExecutingContext()->contextData();
+  JSValue own_prototype = JS_GetPrototype(ctx(), ToQuickJSUnsafe());
+  JSValue prototype = context_data->prototypeForShape(className());
+  if (JS_IsNull(prototype)) {
+    // Chained to the prototype of the first object of the class, which keeps JS subclass prototypes in the chain.
+    prototype = CreateShapePrototype(shape, own_prototype);
+    context_data->SetPrototypeForShape(className(), prototype);
+  }
+
+  bool linked = IsSameObject(own_prototype, prototype);
+  if (!linked) {
+    // Objects created before dart synced the shape are moved onto it once, later ones are created on it.
+    JSValue parent = JS_GetPrototype(ctx(), prototype);
+    if (IsSameObject(own_prototype, parent)) {
+      JS_SetPrototype(ctx(), ToQuickJSUnsafe(), prototype);
+      linked = true;
+    }
+    JS_FreeValue(ctx(), parent);
+  }
+  JS_FreeValue(ctx(), own_prototype);
+
+  if (!linked)
+    return false;
+
+  // QuickJS resolves everything through the prototype chain from now on, the exotic item() hooks are skipped.
+  JS_SetObjectExotic(ToQuickJSUnsafe(), false);
+  for (auto& entry : unimplemented_properties_) {
+    JS_DefinePropertyValue(ctx(), ToQuickJSUnsafe(), entry.first.Impl(), JS_DupValue(ctx(), entry.second.QJSValue()),
+                           JS_PROP_C_W_E);
+  }
+  unimplemented_properties_.clear();
+  shape_prototype_linked_ = true;
+  return true;
+}
+
+JSValue EventTarget::CreateShapePrototype(const WidgetElementShape* shape, JSValue parent) {
+  JSValue prototype = JS_NewObjectProto(ctx(), parent);
+  JS_DefinePropertyValue(ctx(), prototype, JS_ATOM_Symbol_toStringTag, className().ToQuickJS(ctx()),
+                         JS_PROP_CONFIGURABLE);
+
+  for (auto& entry : shape->built_in_properties_) {
+    JSValue id = JS_NewInt32(ctx(), entry.second);
+    JSValue getter = JS_NewCFunctionData(ctx(), ShapePropertyGetter, 0, 0, 1, &id);
+    JSValue setter = JS_NewCFunctionData(ctx(), ShapePropertySetter, 1, 0, 1, &id);
+    JS_DefinePropertyGetSet(ctx(), prototype, entry.first.Impl(), getter, setter,
+                            JS_PROP_CONFIGURABLE | JS_PROP_ENUMERABLE);
+  }
+
+  // Methods call back to dart with the receiver, so one function per class is enough.
+  for (auto& entry : shape->built_in_methods_) {
+    ScriptValue func = CreateSyncMethodFunc(entry.first, entry.second);
+    JS_DefinePropertyValue(ctx(), prototype, entry.first.Impl(), JS_DupValue(ctx(), func.QJSValue()), JS_PROP_C_W_E);
+  }
+
+  for (auto& entry : shape->built_in_async_methods_) {
+    ScriptValue func = CreateAsyncMethodFunc(entry.first, entry.second);
+    JS_DefinePropertyValue(ctx(), prototype, entry.first.Impl(), JS_DupValue(ctx(), func.QJSValue()), JS_PROP_C_W_E);
+  }
+
+  return prototype;
+}
+
+JSValue EventTarget::ShapePropertyGetter(JSContext* ctx,
+                                         JSValueConst this_val,
+                                         int argc,
+                                         JSValueConst* argv,
+                                         int magic,
+                                         JSValue* func_data) {
+  auto* event_target = toScriptWrappable<EventTarget>(this_val);
+  if (event_target == nullptr)
+    return JS_ThrowTypeError(ctx, "Illegal invocation");
+
+  ExceptionState exception_state;
+  NativeValue result = event_target->GetBindingProperty(JS_VALUE_GET_INT(func_data[0]), exception_state);
+  if (UNLIKELY(exception_state.HasException())) {
+    return exception_state.ToQuickJS();
+  }
+  return JS_DupValue(ctx, ScriptValue(ctx, result).QJSValue());
+}
+
+JSValue EventTarget::ShapePropertySetter(JSContext* ctx,
+                                         JSValueConst this_val,
+                                         int argc,
+                                         JSValueConst* argv,
+                                         int magic,
+                                         JSValue* func_data) {
+  auto* event_target = toScriptWrappable<EventTarget>(this_val);
+  if (event_target == nullptr)
+    return JS_ThrowTypeError(ctx, "Illegal invocation");
+
+  ExceptionState exception_state;
+  NativeValue value = ScriptValue(ctx, argc > 0 ? argv[0] : JS_UNDEFINED).ToNative(ctx, exception_state);
+  if (UNLIKELY(exception_state.HasException())) {
+    return exception_state.ToQuickJS();
+  }
+  event_target->SetBindingProperty(JS_VALUE_GET_INT(func_data[0]), value, exception_state);
+  if (UNLIKELY(exception_state.HasException())) {
+    return exception_state.ToQuickJS();
+  }
+  return JS_UNDEFINED;
+}
+
+ScriptValue EventTarget::CreateSyncMethodFunc(const AtomicString& method_name, int32_t method_id) {
   auto* data = new BindingObject::AnonymousFunctionData();
   data->method_name = method_name.ToStdString(ctx());
+  data->method_id = method_id;
   return ScriptValue(ctx(),
                      QJSFunction::Create(ctx(), BindingObject::AnonymousFunctionCallback, 1, data)->ToQuickJSUnsafe());
 }
 
-ScriptValue EventTarget::CreateAsyncMethodFunc(const AtomicString& method_name) {
+ScriptValue EventTarget::CreateAsyncMethodFunc(const AtomicString& method_name, int32_t method_id) {
   auto* data = new BindingObject::AnonymousFunctionData();
   data->method_name = method_name.ToStdString(ctx());
+  data->method_id = method_id;
   return ScriptValue(
       ctx(), QJSFunction::Create(ctx(), BindingObject::AnonymousAsyncFunctionCallback, 4, data)->ToQuickJSUnsafe());
 }
@@ -42,6 +42,47 @@ enum class DispatchEventResult {
   kCanceledBeforeDispatch,
 };
 
+// Listener options passed to the Dart side within kAddEvent commands.
+struct DartEventListenerOptions : public DartReadable {
+  bool capture{false};
+};
+
+struct DartAddEventListenerOptions : public DartEventListenerOptions {
+  bool passive{false};
+  bool once{false};
+};
+
+// What the Dart side needs to know about the JS listeners of one event type on a target, so it can skip dispatching
+// events nobody listens to, or dispatch without waiting for the result when no listener is able to preventDefault.
+// Sent within kUpdateEventListenerSummary commands whenever a listener is added or removed, packed into the pointer
+// field of the command as |listener_count << 2 | has_capture << 1 | has_non_passive|.
+struct EventListenerSummary {
+  uint32_t listener_count{0};
+  bool has_non_passive{false};
+  bool has_capture{false};
+
+  int64_t Pack() const {
+    return static_cast<int64_t>(listener_count) << 2 | (has_capture ? 2 : 0) | (has_non_passive ? 1 : 0);
+  }
+};
+
+struct EventDispatchResult : public DartReadable {
+  bool canceled{false};
+  bool propagationStopped{false};
+};
+
+struct RawEvent;
+
+// One event of a batch dispatched from dart, the type string is borrowed and may be shared by several entries.
+struct NativeEventDispatch {
+  NativeBindingObject* target;
+  SharedNativeString* type;
+  RawEvent* raw_event;
+  int8_t is_capture;
+  // Opt in to recycle the Event wrapper through the EventPool of the context.
+  int8_t recycle;
+};
+
 struct FiringEventIterator {
   MERCURY_DISALLOW_NEW();
 
@@ -74,6 +115,7 @@ class EventTargetData final {
 };
 
 class Node;
+struct WidgetElementShape;
 
 // All DOM event targets extend EventTarget. The spec is defined here:
 // https://dom.spec.whatwg.org/#interface-eventtarget
@@ -122,6 +164,13 @@ class EventTarget : public BindingObject {
 
   static DispatchEventResult GetDispatchEventResult(const Event&);
 
+  // Fire a batch of events sent from dart at their targets within one mutation scope. Results are written in the order
+  // of the dispatches, entries whose target is gone are left as not canceled.
+  static void HandleDispatchEventsFromDart(ExecutingContext* context,
+                                           const NativeEventDispatch* dispatches,
+                                           int32_t count,
+                                           EventDispatchResult* results);
+
   // Used for legacy "onEvent" attribute APIs.
   bool SetAttributeEventListener(const AtomicString& event_type,
                                  const std::shared_ptr<EventListener>& listener,
@@ -140,6 +189,7 @@ class EventTarget : public BindingObject {
                                      Dart_Handle dart_object) override;
 
   void Trace(GCVisitor* visitor) const override;
+  void InitializeQuickJSObject() override;
 
   bool NamedPropertyQuery(const AtomicString& key, ExceptionState& exception_state);
   void NamedPropertyEnumerator(std::vector<AtomicString>& names, ExceptionState&);
@@ -158,7 +208,10 @@ class EventTarget : public BindingObject {
 
   DispatchEventResult DispatchEventInternal(Event& event, ExceptionState& exception_state);
 
+  JSValue InitialPrototype() override;
+
   NativeValue HandleDispatchEventFromDart(int32_t argc, const NativeValue* argv, Dart_Handle dart_object);
+  DispatchEventResult FireEventFromDart(Event& event, bool is_capture);
 
   // Subclasses should likely not override these themselves; instead, they
   // should subclass EventTargetWithInlineData.
@@ -167,16 +220,38 @@ class EventTarget : public BindingObject {
 
  private:
   RegisteredEventListener* GetAttributeRegisteredEventListener(const AtomicString& event_type);
+  EventListenerSummary GetEventListenerSummary(const AtomicString& event_type);
+  void SendEventListenerSummary(const AtomicString& event_type);
 
-  bool FireEventListeners(Event&, EventTargetData*, EventListenerVector&, ExceptionState&);
+  bool FireEventListeners(Event&, EventTargetData*, EventListenerMap&, ExceptionState&);
 
-  ScriptValue CreateSyncMethodFunc(const AtomicString& method_name);
-  ScriptValue CreateAsyncMethodFunc(const AtomicString& method_name);
+  ScriptValue CreateSyncMethodFunc(const AtomicString& method_name, int32_t method_id);
+  ScriptValue CreateAsyncMethodFunc(const AtomicString& method_name, int32_t method_id);
   NativeValue HandleSyncPropertiesAndMethodsFromDart(int32_t argc, const NativeValue* argv);
 
+  // Once dart synced the shape of this class, objects are linked to a per-class prototype which carries real accessors
+  // and methods for it, so accesses are resolved by QuickJS instead of the exotic item() lookup. Returns false while
+  // the object can not be linked.
+  bool UsesShapePrototype() const;
+  bool LinkShapePrototype();
+  JSValue CreateShapePrototype(const WidgetElementShape* shape, JSValue parent);
+  static JSValue ShapePropertyGetter(JSContext* ctx,
+                                     JSValueConst this_val,
+                                     int argc,
+                                     JSValueConst* argv,
+                                     int magic,
+                                     JSValue* func_data);
+  static JSValue ShapePropertySetter(JSContext* ctx,
+                                     JSValueConst this_val,
+                                     int argc,
+                                     JSValueConst* argv,
+                                     int magic,
+                                     JSValue* func_data);
+
   std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> cached_methods_;
   std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> async_cached_methods_;
   std::unordered_map<AtomicString, ScriptValue, AtomicString::KeyHasher> unimplemented_properties_;
+  bool shape_prototype_linked_{false};
 
   AtomicString className_;
 };
@@ -12,6 +12,7 @@
 #include "core/event/builtin/error_event.h"
 #include "core/event/builtin/promise_rejection_event.h"
 #include "event_type_names.h"
+#include "foundation/utf_transcoding.h"
 #include "polyfill.h"
 #include "qjs_global.h"
 
@@ -79,6 +80,11 @@ ExecutingContext::~ExecutingContext() {
 
   JS_FreeValue(script_state_.ctx(), global_object_);
 
+  event_pool_.Clear();
+
+  // Dart may still read the buffers it was given, they are kept past the context.
+  dart_isolate_context_->EnsureData()->nativeTypedArrays()->DetachContext(ctx());
+
   // Free active wrappers.
   for (auto& active_wrapper : active_wrappers_) {
     JS_FreeValue(ctx(), active_wrapper->ToQuickJSUnsafe());
@@ -95,13 +101,39 @@ bool ExecutingContext::EvaluateJavaScript(const uint16_t* code,
                                           uint64_t* bytecode_len,
                                           const char* sourceURL,
                                           int startLine) {
-  std::string utf8Code = toUTF8(std::u16string(reinterpret_cast<const char16_t*>(code), codeLength));
+  std::string utf8Code = toUTF8(code, codeLength);
+  return EvaluateUTF8JavaScript(utf8Code.c_str(), utf8Code.size(), parsed_bytecodes, bytecode_len, sourceURL);
+}
+
+bool ExecutingContext::EvaluateJavaScriptInPlace(uint16_t* code,
+                                                 size_t codeLength,
+                                                 uint8_t** parsed_bytecodes,
+                                                 uint64_t* bytecode_len,
+                                                 const char* sourceURL,
+                                                 int startLine) {
+  size_t utf8_length;
+  if (!UTF16ToUTF8FitsInPlace(code, codeLength, &utf8_length)) {
+    return EvaluateJavaScript(code, codeLength, parsed_bytecodes, bytecode_len, sourceURL, startLine);
+  }
+
+  auto* utf8Code = reinterpret_cast<char*>(code);
+  ConvertUTF16ToUTF8(code, codeLength, utf8Code);
+  utf8Code[utf8_length] = '\0';
+  return EvaluateUTF8JavaScript(utf8Code, utf8_length, parsed_bytecodes, bytecode_len, sourceURL);
+}
+
+bool ExecutingContext::EvaluateUTF8JavaScript(const char* code,
+                                              size_t codeLength,
+                                              uint8_t** parsed_bytecodes,
+                                              uint64_t* bytecode_len,
+                                              const char* sourceURL) {
+  ScriptTurnScope script_turn_scope(isolateCommandBuffer());
   JSValue result;
   if (parsed_bytecodes == nullptr) {
-    result = JS_Eval(script_state_.ctx(), utf8Code.c_str(), utf8Code.size(), sourceURL, JS_EVAL_TYPE_GLOBAL);
+    result = JS_Eval(script_state_.ctx(), code, codeLength, sourceURL, JS_EVAL_TYPE_GLOBAL);
   } else {
-    JSValue byte_object = JS_Eval(script_state_.ctx(), utf8Code.c_str(), utf8Code.size(), sourceURL,
-                                  JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    JSValue byte_object =
+        JS_Eval(script_state_.ctx(), code, codeLength, sourceURL, JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
     if (JS_IsException(byte_object)) {
       HandleException(&byte_object);
       return false;
@@ -121,7 +153,8 @@ bool ExecutingContext::EvaluateJavaScript(const uint16_t* code,
 }
 
 bool ExecutingContext::EvaluateJavaScript(const char16_t* code, size_t length, const char* sourceURL, int startLine) {
-  std::string utf8Code = toUTF8(std::u16string(reinterpret_cast<const char16_t*>(code), length));
+  ScriptTurnScope script_turn_scope(isolateCommandBuffer());
+  std::string utf8Code = toUTF8(reinterpret_cast<const uint16_t*>(code), length);
   JSValue result = JS_Eval(script_state_.ctx(), utf8Code.c_str(), utf8Code.size(), sourceURL, JS_EVAL_TYPE_GLOBAL);
   DrainPendingPromiseJobs();
   bool success = HandleException(&result);
@@ -130,6 +163,7 @@ bool ExecutingContext::EvaluateJavaScript(const char16_t* code, size_t length, c
 }
 
 bool ExecutingContext::EvaluateJavaScript(const char* code, size_t codeLength, const char* sourceURL, int startLine) {
+  ScriptTurnScope script_turn_scope(isolateCommandBuffer());
   JSValue result = JS_Eval(script_state_.ctx(), code, codeLength, sourceURL, JS_EVAL_TYPE_GLOBAL);
   DrainPendingPromiseJobs();
   bool success = HandleException(&result);
@@ -138,6 +172,7 @@ bool ExecutingContext::EvaluateJavaScript(const char* code, size_t codeLength, c
 }
 
 bool ExecutingContext::EvaluateByteCode(uint8_t* bytes, size_t byteLength) {
+  ScriptTurnScope script_turn_scope(isolateCommandBuffer());
   JSValue obj, val;
   obj = JS_ReadObject(script_state_.ctx(), bytes, byteLength, JS_READ_OBJ_BYTECODE);
   if (!HandleException(&obj))
@@ -304,7 +339,16 @@ static void DispatchPromiseRejectionEvent(const AtomicString& event_type,
 
 void ExecutingContext::FlushIsolateCommand() {
   if (!isolateCommandBuffer()->empty()) {
+    auto start = std::chrono::steady_clock::now();
     dartMethodPtr()->flushIsolateCommand(context_id_);
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    isolateCommandBuffer()->RecordFlushLatency(latency.count());
+  }
+}
+
+void ExecutingContext::FlushIsolateCommand(const NativeBindingObject* binding_object) {
+  if (isolateCommandBuffer()->HasPendingCommands(binding_object)) {
+    FlushIsolateCommand();
   }
 }
 
@@ -18,6 +18,7 @@
 #include <unordered_map>
 #include "bindings/qjs/rejected_promises.h"
 #include "bindings/qjs/script_value.h"
+#include "core/event/event_pool.h"
 #include "dart_isolate_context.h"
 #include "dart_methods.h"
 #include "executing_context_data.h"
@@ -43,6 +44,7 @@ class MemberMutationScope;
 class ErrorEvent;
 class DartContext;
 class ScriptWrappable;
+struct NativeBindingObject;
 
 using JSExceptionHandler = std::function<void(ExecutingContext* context, const char* message)>;
 
@@ -68,6 +70,14 @@ class ExecutingContext {
                           uint64_t* bytecode_len,
                           const char* sourceURL,
                           int startLine);
+  // Same as above, but the UTF-8 encoding is written over the source buffer when it fits, so bundles are parsed
+  // without another copy of the source. The caller must not read the buffer afterwards.
+  bool EvaluateJavaScriptInPlace(uint16_t* code,
+                                 size_t codeLength,
+                                 uint8_t** parsed_bytecodes,
+                                 uint64_t* bytecode_len,
+                                 const char* sourceURL,
+                                 int startLine);
   bool EvaluateJavaScript(const char16_t* code, size_t length, const char* sourceURL, int startLine);
   bool EvaluateJavaScript(const char* code, size_t codeLength, const char* sourceURL, int startLine);
   bool EvaluateByteCode(uint8_t* bytes, size_t byteLength);
@@ -109,6 +119,9 @@ class ExecutingContext {
   // Get current script state.
   ScriptState* GetScriptState() { return &script_state_; }
 
+  // Recycled Event wrappers of events dispatched from dart.
+  EventPool* eventPool() { return &event_pool_; }
+
   void SetMutationScope(MemberMutationScope& mutation_scope);
   bool HasMutationScope() const { return active_mutation_scope != nullptr; }
   MemberMutationScope* mutationScope() const { return active_mutation_scope; }
@@ -126,6 +139,9 @@ class ExecutingContext {
   FORCE_INLINE IsolateCommandBuffer* isolateCommandBuffer() { return &isolate_command_buffer_; };
 
   void FlushIsolateCommand();
+  // Flush only when pending commands reference the binding object. Dart applies commands in order, so the whole
+  // buffer is flushed in that case.
+  void FlushIsolateCommand(const NativeBindingObject* binding_object);
 
   void DispatchErrorEvent(ErrorEvent* error_event);
   void DispatchErrorEventInterval(ErrorEvent* error_event);
@@ -146,6 +162,13 @@ class ExecutingContext {
   std::chrono::time_point<std::chrono::system_clock> time_origin_;
   int32_t unique_id_;
 
+  // |code| must be NUL terminated, as required by the QuickJS parser.
+  bool EvaluateUTF8JavaScript(const char* code,
+                              size_t codeLength,
+                              uint8_t** parsed_bytecodes,
+                              uint64_t* bytecode_len,
+                              const char* sourceURL);
+
   static void promiseRejectTracker(JSContext* ctx,
                                    JSValueConst promise,
                                    JSValueConst reason,
@@ -174,6 +197,7 @@ class ExecutingContext {
   ExecutionContextData context_data_{this};
   bool in_dispatch_error_event_{false};
   RejectedPromises rejected_promises_;
+  EventPool event_pool_;
   MemberMutationScope* active_mutation_scope{nullptr};
   std::set<ScriptWrappable*> active_wrappers_;
 };
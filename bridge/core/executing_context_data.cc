@@ -25,6 +25,16 @@ JSValue ExecutionContextData::prototypeForType(const WrapperTypeInfo* type) {
   return it != prototype_map_.end() ? it->second : JS_NULL;
 }
 
+JSValue ExecutionContextData::prototypeForShape(const AtomicString& class_name) {
+  auto it = shape_prototype_map_.find(class_name);
+  return it != shape_prototype_map_.end() ? it->second : JS_NULL;
+}
+
+void ExecutionContextData::SetPrototypeForShape(const AtomicString& class_name, JSValue prototype) {
+  assert(shape_prototype_map_.count(class_name) == 0);
+  shape_prototype_map_[class_name] = prototype;
+}
+
 JSValue ExecutionContextData::constructorForIdSlowCase(const WrapperTypeInfo* type) {
   JSContext* ctx = m_context->ctx();
 
@@ -84,6 +94,10 @@ void ExecutionContextData::Dispose() {
   for (auto& entry : constructor_map_) {
     JS_FreeValueRT(m_context->dartIsolateContext()->runtime(), entry.second);
   }
+
+  for (auto& entry : shape_prototype_map_) {
+    JS_FreeValueRT(m_context->dartIsolateContext()->runtime(), entry.second);
+  }
 }
 
 }  // namespace mercury
@@ -19,7 +19,10 @@ namespace mercury {
 
 ConsoleMessageHandler MercuryIsolate::consoleMessageHandler{nullptr};
 
-MercuryIsolate::MercuryIsolate(DartIsolateContext* dart_isolate_context, int32_t contextId, const JSExceptionHandler& handler)
+MercuryIsolate::MercuryIsolate(DartIsolateContext* dart_isolate_context,
+                               int32_t contextId,
+                               const JSExceptionHandler& handler,
+                               const IsolateCommandFlushPolicy& flush_policy)
     : contextId(contextId), ownerThreadId(std::this_thread::get_id()) {
   context_ = new ExecutingContext(
       dart_isolate_context, contextId,
@@ -30,6 +33,7 @@ MercuryIsolate::MercuryIsolate(DartIsolateContext* dart_isolate_context, int32_t
         MERCURY_LOG(ERROR) << message << std::endl;
       },
       this);
+  context_->isolateCommandBuffer()->SetFlushPolicy(flush_policy);
 }
 
 NativeValue* MercuryIsolate::invokeModuleEvent(SharedNativeString* native_module_name,
@@ -78,15 +82,16 @@ NativeValue* MercuryIsolate::invokeModuleEvent(SharedNativeString* native_module
   return return_value;
 }
 
-bool MercuryIsolate::evaluateScript(const SharedNativeString* script,
+bool MercuryIsolate::evaluateScript(SharedNativeString* script,
                               uint8_t** parsed_bytecodes,
                               uint64_t* bytecode_len,
                               const char* url,
                               int startLine) {
   if (!context_->IsContextValid())
     return false;
-  return context_->EvaluateJavaScript(script->string(), script->length(), parsed_bytecodes, bytecode_len, url,
-                                      startLine);
+  // The characters are allocated by dart and freed right after the evaluation.
+  return context_->EvaluateJavaScriptInPlace(const_cast<uint16_t*>(script->string()), script->length(),
+                                             parsed_bytecodes, bytecode_len, url, startLine);
 }
 
 bool MercuryIsolate::evaluateScript(const uint16_t* script,
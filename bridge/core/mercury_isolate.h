@@ -32,14 +32,18 @@ class MercuryIsolate final {
  public:
   static ConsoleMessageHandler consoleMessageHandler;
   MercuryIsolate() = delete;
-  MercuryIsolate(DartIsolateContext* dart_isolate_context, int32_t jsContext, const JSExceptionHandler& handler);
+  MercuryIsolate(DartIsolateContext* dart_isolate_context,
+                 int32_t jsContext,
+                 const JSExceptionHandler& handler,
+                 const IsolateCommandFlushPolicy& flush_policy = IsolateCommandFlushPolicy());
   ~MercuryIsolate();
 
   // Bytecodes which registered by mercury plugins.
   static std::unordered_map<std::string, NativeByteCode> pluginByteCode;
 
   // evaluate JavaScript source codes in standard mode.
-  bool evaluateScript(const SharedNativeString* script,
+  // The script buffer is consumed: it may be overwritten by the UTF-8 encoding of the source.
+  bool evaluateScript(SharedNativeString* script,
                       uint8_t** parsed_bytecodes,
                       uint64_t* bytecode_len,
                       const char* url,
@@ -17,7 +17,8 @@
 namespace mercury {
 
 Global::Global(ExecutingContext* context) : EventTargetWithInlineData(context, built_in_string::kglobalThis) {
-  context->isolateCommandBuffer()->addCommand(IsolateCommand::kCreateGlobal, nullptr, (void*)bindingObject(), nullptr);
+  context->isolateCommandBuffer()->addCommand(IsolateCommand::kCreateGlobal, className(), (void*)bindingObject(),
+                                              nullptr);
 }
 
 // https://infra.spec.whatwg.org/#ascii-whitespace
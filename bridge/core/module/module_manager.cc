@@ -5,6 +5,7 @@
 #include "module_manager.h"
 #include "core/executing_context.h"
 #include "foundation/logging.h"
+#include "foundation/native_value_arena.h"
 #include "module_callback.h"
 
 namespace mercury {
@@ -100,7 +101,9 @@ ScriptValue ModuleManager::__mercury_invoke_module__(ExecutingContext* context,
                                                   ScriptValue& params_value,
                                                   const std::shared_ptr<QJSFunction>& callback,
                                                   ExceptionState& exception) {
-  NativeValue params = params_value.ToNative(context->ctx(), exception);
+  // Params are read by dart during invokeModule, and released together with the arena after it returns.
+  NativeValueArena arena;
+  NativeValue params = params_value.ToNative(context->ctx(), &arena, exception);
 
   if (exception.HasException()) {
     return ScriptValue::Empty(context->ctx());
@@ -113,18 +116,23 @@ ScriptValue ModuleManager::__mercury_invoke_module__(ExecutingContext* context,
     return ScriptValue::Empty(context->ctx());
   }
 
+  // Module and method names are borrowed from the string cache during the call.
+  NativeStringCache* string_cache = context->dartIsolateContext()->EnsureData()->nativeStringCache();
+  CachedNativeString native_module_name = string_cache->Get(context->ctx(), module_name);
+  CachedNativeString native_method = string_cache->Get(context->ctx(), method);
+
   NativeValue* result;
   if (callback != nullptr) {
     auto module_callback = ModuleCallback::Create(callback);
     auto module_context = std::make_shared<ModuleContext>(context, module_callback);
     context->ModuleContexts()->AddModuleContext(module_context);
     result = context->dartMethodPtr()->invokeModule(
-        module_context.get(), context->contextId(), module_name.ToNativeString(context->ctx()).release(),
-        method.ToNativeString(context->ctx()).release(), &params, handleInvokeModuleTransientCallback);
+        module_context.get(), context->contextId(), native_module_name.get(), native_method.get(), &params,
+        handleInvokeModuleTransientCallback);
   } else {
     result = context->dartMethodPtr()->invokeModule(
-        nullptr, context->contextId(), module_name.ToNativeString(context->ctx()).release(),
-        method.ToNativeString(context->ctx()).release(), &params, handleInvokeModuleUnexpectedCallback);
+        nullptr, context->contextId(), native_module_name.get(), native_method.get(), &params,
+        handleInvokeModuleUnexpectedCallback);
   }
 
   if (result == nullptr) {
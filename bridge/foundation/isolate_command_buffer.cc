@@ -4,26 +4,111 @@
  */
 
 #include "isolate_command_buffer.h"
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include "bindings/qjs/atomic_string.h"
 #include "core/dart_methods.h"
+#include "core/event/event_target.h"
 #include "core/executing_context.h"
 #include "foundation/logging.h"
 #include "include/mercury_bridge.h"
 
 namespace mercury {
 
-IsolateCommandBuffer::IsolateCommandBuffer(ExecutingContext* context)
-    : context_(context), buffer_((IsolateCommandItem*)malloc(sizeof(IsolateCommandItem) * MAXIMUM_ISOLATE_COMMAND_SIZE)) {}
+namespace {
+
+// Identify the listener slot on the Dart side that kAddEvent and kRemoveEvent commands operate on.
+struct EventCommandKey {
+  int64_t native_ptr;
+  std::u16string_view event_type;
+  bool capture;
+
+  bool operator==(const EventCommandKey& other) const {
+    return native_ptr == other.native_ptr && capture == other.capture && event_type == other.event_type;
+  }
+};
+
+struct EventCommandKeyHash {
+  size_t operator()(const EventCommandKey& key) const {
+    return std::hash<int64_t>()(key.native_ptr) ^ (std::hash<std::u16string_view>()(key.event_type) << 1) ^
+           static_cast<size_t>(key.capture);
+  }
+};
+
+EventCommandKey GetEventCommandKey(const IsolateCommandItem& item) {
+  bool capture;
+  if (static_cast<IsolateCommand>(item.type) == IsolateCommand::kAddEvent) {
+    auto* options = reinterpret_cast<DartAddEventListenerOptions*>(item.nativePtr2);
+    capture = options != nullptr && options->capture;
+  } else if (static_cast<IsolateCommand>(item.type) == IsolateCommand::kUpdateEventListenerSummary) {
+    // The summary covers the listeners of both phases.
+    capture = false;
+  } else {
+    capture = item.nativePtr2 == 0x01;
+  }
+  return {item.nativePtr,
+          std::u16string_view(reinterpret_cast<const char16_t*>(item.string_01), item.args_01_length), capture};
+}
+
+// Elided commands never reach the Dart side, so the resources which Dart should take over are released here.
+// String payloads are owned by the arena of the buffer.
+void ReleaseCommandResources(const IsolateCommandItem& item) {
+  switch (static_cast<IsolateCommand>(item.type)) {
+    case IsolateCommand::kAddEvent:
+      delete reinterpret_cast<DartAddEventListenerOptions*>(item.nativePtr2);
+      break;
+    case IsolateCommand::kDisposeBindingObject:
+      // The Dart side had never seen this binding object, no one else will free it.
+      delete reinterpret_cast<NativeBindingObject*>(item.nativePtr);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+static constexpr int32_t kElidedCommandType = -1;
+// Upper bounds in microseconds of the flush latency buckets, the last bucket has no upper bound.
+static constexpr int64_t kFlushLatencyBuckets[] = {50, 100, 250, 500, 1000, 2500, 5000};
+
+static_assert(sizeof(kFlushLatencyBuckets) / sizeof(int64_t) + 1 == ISOLATE_COMMAND_LATENCY_BUCKET_COUNT,
+              "Every latency bucket except the last one needs an upper bound");
+static_assert(static_cast<int32_t>(IsolateCommand::kUpdateEventListenerSummary) + 1 == ISOLATE_COMMAND_TYPE_COUNT,
+              "ISOLATE_COMMAND_TYPE_COUNT should match the count of IsolateCommand");
+
+IsolateCommandBuffer::IsolateCommandBuffer(ExecutingContext* context) : context_(context) {
+  buffer_.head = buffer_.tail = new IsolateCommandChunk();
+  buffer_.chunk_count = 1;
+}
 
 IsolateCommandBuffer::~IsolateCommandBuffer() {
-  free(buffer_);
+  IsolateCommandChunk* chunk = buffer_.head;
+  while (chunk != nullptr) {
+    IsolateCommandChunk* next = chunk->next;
+    delete chunk;
+    chunk = next;
+  }
+}
+
+void IsolateCommandBuffer::addCommand(IsolateCommand type,
+                                      void* nativePtr,
+                                      void* nativePtr2,
+                                      bool request_isolate_update) {
+  IsolateCommandItem item{static_cast<int32_t>(type), nullptr, 0, nativePtr, nativePtr2};
+  addCommand(item, request_isolate_update);
 }
 
 void IsolateCommandBuffer::addCommand(IsolateCommand type,
-                                 std::unique_ptr<SharedNativeString>&& args_01,
-                                 void* nativePtr,
-                                 void* nativePtr2,
-                                 bool request_isolate_update) {
-  IsolateCommandItem item{static_cast<int32_t>(type), args_01.get(), nativePtr, nativePtr2};
+                                      const AtomicString& args_01,
+                                      void* nativePtr,
+                                      void* nativePtr2,
+                                      bool request_isolate_update) {
+  CachedNativeString cached =
+      context_->dartIsolateContext()->EnsureData()->nativeStringCache()->Get(context_->ctx(), args_01);
+  IsolateCommandItem item{static_cast<int32_t>(type), cached->string(), cached->length(), nativePtr, nativePtr2};
+  buffer_.retained_strings.emplace_back(std::move(cached));
   addCommand(item, request_isolate_update);
 }
 
@@ -32,39 +117,307 @@ void IsolateCommandBuffer::addCommand(const IsolateCommandItem& item, bool reque
     return;
   }
 
-  if (size_ >= max_size_) {
-    buffer_ = (IsolateCommandItem*)realloc(buffer_, sizeof(IsolateCommandItem) * max_size_ * 2);
-    max_size_ = max_size_ * 2;
+  Buffer& buffer = buffer_;
+  if (buffer.tail->size == ISOLATE_COMMAND_CHUNK_SIZE) {
+    // Chunks are linked instead of reallocated, so commands already queued are never copied or moved.
+    if (buffer.tail->next == nullptr) {
+      buffer.tail->next = new IsolateCommandChunk();
+      buffer.chunk_count++;
+    }
+    buffer.tail = buffer.tail->next;
   }
 
+  if (UNLIKELY(request_isolate_update && !update_batched_ &&
+               (flush_policy_.mode != IsolateCommandFlushMode::kAfterScriptTurn || script_turn_depth_ == 0))) {
+    RequestBatchUpdate();
+  }
+
+  buffer.tail->items[buffer.tail->size++] = item;
+  buffer.size++;
+  // The nativePtr of every command is a NativeBindingObject, which stays alive until the Dart side read the commands.
+  if (item.nativePtr != 0) {
+    reinterpret_cast<NativeBindingObject*>(item.nativePtr)->pending_command_epoch_ = flush_epoch_;
+  }
+  buffer.bytes += sizeof(IsolateCommandItem) + sizeof(uint16_t) * item.args_01_length;
+  telemetry_.command_counts[item.type]++;
+
+  // Commands without isolate update requests are added during GC finalization, it's not safe to call Dart there.
+  if (UNLIKELY(flush_policy_.mode == IsolateCommandFlushMode::kThreshold && request_isolate_update &&
+               !in_threshold_flush_ && ExceedsFlushThreshold(buffer))) {
+    in_threshold_flush_ = true;
+    context_->FlushIsolateCommand();
+    in_threshold_flush_ = false;
+  }
+}
+
+void IsolateCommandBuffer::RequestBatchUpdate() {
 #if FLUTTER_BACKEND
-  if (UNLIKELY(request_isolate_update && !update_batched_ && context_->IsContextValid() &&
-               context_->dartMethodPtr()->requestBatchUpdate != nullptr)) {
+  if (context_->IsContextValid() && context_->dartMethodPtr()->requestBatchUpdate != nullptr) {
     context_->dartMethodPtr()->requestBatchUpdate(context_->contextId());
     update_batched_ = true;
   }
 #endif
+}
+
+bool IsolateCommandBuffer::ExceedsFlushThreshold(const Buffer& buffer) const {
+  return (flush_policy_.max_pending_items > 0 && buffer.size >= flush_policy_.max_pending_items) ||
+         (flush_policy_.max_pending_bytes > 0 && buffer.bytes >= flush_policy_.max_pending_bytes);
+}
+
+void IsolateCommandBuffer::EnterScriptTurn() {
+  script_turn_depth_++;
+}
+
+void IsolateCommandBuffer::LeaveScriptTurn() {
+  script_turn_depth_--;
+  if (flush_policy_.mode == IsolateCommandFlushMode::kAfterScriptTurn && script_turn_depth_ == 0 && !update_batched_ &&
+      !empty()) {
+    RequestBatchUpdate();
+  }
+}
+
+void IsolateCommandBuffer::PrepareFlush() {
+  if (coalescing_enabled_) {
+    CoalesceCommands(buffer_);
+  }
+  EncodeCommands(buffer_);
+  RecordFlush(buffer_);
+  update_batched_ = false;
+}
+
+void IsolateCommandBuffer::CoalesceCommands(Buffer& buffer) {
+  if (buffer.size < 2)
+    return;
+
+  IsolateCommandChunk* end = buffer.tail->next;
+
+  // Binding objects created and disposed within the same flush are invisible to the Dart side.
+  std::unordered_set<int64_t> created_objects;
+  std::unordered_set<int64_t> transient_objects;
+  for (IsolateCommandChunk* chunk = buffer.head; chunk != end; chunk = chunk->next) {
+    for (int64_t i = 0; i < chunk->size; i++) {
+      const IsolateCommandItem& item = chunk->items[i];
+      auto type = static_cast<IsolateCommand>(item.type);
+      if (type == IsolateCommand::kCreateEventTarget) {
+        created_objects.emplace(item.nativePtr);
+      } else if (type == IsolateCommand::kDisposeBindingObject && created_objects.count(item.nativePtr) > 0) {
+        transient_objects.emplace(item.nativePtr);
+      }
+    }
+  }
+
+  // The last kept kAddEvent or kRemoveEvent command for each listener slot.
+  std::unordered_map<EventCommandKey, IsolateCommandItem*, EventCommandKeyHash> last_event_commands;
+  // The last kUpdateEventListenerSummary command for each event type of a target.
+  std::unordered_map<EventCommandKey, IsolateCommandItem*, EventCommandKeyHash> last_summary_commands;
+  int64_t elided_count = 0;
+
+  auto elide = [&](IsolateCommandItem* item) {
+    ReleaseCommandResources(*item);
+    item->type = kElidedCommandType;
+    elided_count++;
+  };
+
+  for (IsolateCommandChunk* chunk = buffer.head; chunk != end; chunk = chunk->next) {
+    for (int64_t i = 0; i < chunk->size; i++) {
+      IsolateCommandItem* item = &chunk->items[i];
+      if (transient_objects.count(item->nativePtr) > 0) {
+        elide(item);
+        continue;
+      }
+
+      auto type = static_cast<IsolateCommand>(item->type);
+      if (type == IsolateCommand::kUpdateEventListenerSummary) {
+        // Each summary replaces the previous one, only the latest is meaningful to the Dart side.
+        EventCommandKey key = GetEventCommandKey(*item);
+        auto last = last_summary_commands.find(key);
+        if (last != last_summary_commands.end()) {
+          elide(last->second);
+          last->second = item;
+        } else {
+          last_summary_commands.emplace(key, item);
+        }
+        continue;
+      }
+      if (type != IsolateCommand::kAddEvent && type != IsolateCommand::kRemoveEvent)
+        continue;
+
+      EventCommandKey key = GetEventCommandKey(*item);
+      auto last = last_event_commands.find(key);
+      if (last == last_event_commands.end()) {
+        last_event_commands.emplace(key, item);
+        continue;
+      }
+
+      if (static_cast<IsolateCommand>(last->second->type) == type) {
+        // Repeated command with the same listener slot takes no effect on the Dart side.
+        elide(item);
+      } else if (type == IsolateCommand::kRemoveEvent) {
+        // A listener added and removed within the same flush.
+        IsolateCommandItem* add_item = last->second;
+        last_event_commands.erase(last);
+        elide(add_item);
+        elide(item);
+      } else {
+        last->second = item;
+      }
+    }
+  }
 
-  buffer_[size_] = item;
-  size_++;
+  if (elided_count == 0)
+    return;
+
+  // Compact the kept commands to the front chunks. The write position never passes the read position.
+  IsolateCommandChunk* write_chunk = buffer.head;
+  int64_t write_index = 0;
+  for (IsolateCommandChunk* chunk = buffer.head; chunk != end; chunk = chunk->next) {
+    int64_t chunk_size = chunk->size;
+    for (int64_t i = 0; i < chunk_size; i++) {
+      if (chunk->items[i].type == kElidedCommandType)
+        continue;
+      if (write_index == ISOLATE_COMMAND_CHUNK_SIZE) {
+        write_chunk->size = write_index;
+        write_chunk = write_chunk->next;
+        write_index = 0;
+      }
+      write_chunk->items[write_index++] = chunk->items[i];
+    }
+  }
+  write_chunk->size = write_index;
+  for (IsolateCommandChunk* chunk = write_chunk->next; chunk != end; chunk = chunk->next) {
+    chunk->size = 0;
+  }
+  buffer.tail = write_chunk;
+  buffer.size -= elided_count;
+  elided_command_count_ += elided_count;
 }
 
-IsolateCommandItem* IsolateCommandBuffer::data() {
-  return buffer_;
+void IsolateCommandBuffer::EncodeCommands(Buffer& buffer) {
+  IsolateCommandStreamWriter& stream = buffer.stream;
+  stream.Reset();
+  if (buffer.size == 0)
+    return;
+
+  stream.WriteHeader(buffer.size);
+  int64_t previous_ptr = 0;
+  int64_t previous_options = 0;
+  int64_t previous_string = 0;
+  for (IsolateCommandChunk* chunk = buffer.head; chunk != buffer.tail->next; chunk = chunk->next) {
+    for (int64_t i = 0; i < chunk->size; i++) {
+      const IsolateCommandItem& item = chunk->items[i];
+      const auto* string = reinterpret_cast<const uint16_t*>(item.string_01);
+      stream.WriteVarUint(item.type);
+      stream.WritePointer(item.nativePtr, &previous_ptr);
+      switch (static_cast<IsolateCommand>(item.type)) {
+        case IsolateCommand::kCreateGlobal:
+        case IsolateCommand::kCreateEventTarget:
+          stream.WriteStringPointer(string, item.args_01_length, &previous_string);
+          break;
+        case IsolateCommand::kAddEvent:
+          stream.WriteStringPointer(string, item.args_01_length, &previous_string);
+          stream.WritePointer(item.nativePtr2, &previous_options);
+          break;
+        case IsolateCommand::kRemoveEvent:
+          stream.WriteStringPointer(string, item.args_01_length, &previous_string);
+          // The capture flag.
+          stream.WriteVarUint(item.nativePtr2 == 0x01 ? 1 : 0);
+          break;
+        case IsolateCommand::kUpdateEventListenerSummary:
+          stream.WriteStringPointer(string, item.args_01_length, &previous_string);
+          // The packed summary.
+          stream.WriteVarUint(item.nativePtr2);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+void IsolateCommandBuffer::TrimChunks(Buffer& buffer, int64_t used_chunks) {
+  // Follow the recent peak of the used chunks, and decay it gradually so memory are returned after a burst.
+  buffer.high_water_chunks = std::max(used_chunks, buffer.high_water_chunks - buffer.high_water_chunks / 4);
+  int64_t retained_chunks = std::max(buffer.high_water_chunks, static_cast<int64_t>(ISOLATE_COMMAND_RETAINED_CHUNKS));
+  if (buffer.chunk_count <= retained_chunks)
+    return;
+
+  IsolateCommandChunk* last = buffer.head;
+  for (int64_t i = 1; i < retained_chunks; i++) {
+    last = last->next;
+  }
+  IsolateCommandChunk* chunk = last->next;
+  last->next = nullptr;
+  while (chunk != nullptr) {
+    IsolateCommandChunk* next = chunk->next;
+    delete chunk;
+    chunk = next;
+  }
+  buffer.chunk_count = retained_chunks;
+}
+
+void IsolateCommandBuffer::RecordFlush(Buffer& buffer) {
+  if (buffer.size == 0)
+    return;
+
+  int64_t bytes = buffer.stream.length();
+  telemetry_.flush_count++;
+  telemetry_.total_bytes += bytes;
+  telemetry_.last_flush_bytes = bytes;
+  telemetry_.max_flush_bytes = std::max(telemetry_.max_flush_bytes, bytes);
+  telemetry_.max_buffer_size = std::max(telemetry_.max_buffer_size, buffer.size);
+
+  flushes_in_window_++;
+  auto now = std::chrono::steady_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - flush_window_start_);
+  if (elapsed.count() >= 1) {
+    telemetry_.flushes_per_second = flushes_in_window_ / elapsed.count();
+    flush_window_start_ = now;
+    flushes_in_window_ = 0;
+  }
+}
+
+void IsolateCommandBuffer::RecordFlushLatency(int64_t microseconds) {
+  int bucket = 0;
+  while (bucket < ISOLATE_COMMAND_LATENCY_BUCKET_COUNT - 1 && microseconds > kFlushLatencyBuckets[bucket]) {
+    bucket++;
+  }
+  telemetry_.latency_histogram[bucket]++;
+}
+
+const uint8_t* IsolateCommandBuffer::stream() {
+  return buffer_.stream.data();
+}
+
+int64_t IsolateCommandBuffer::streamLength() {
+  return buffer_.stream.length();
 }
 
 int64_t IsolateCommandBuffer::size() {
-  return size_;
+  return buffer_.size;
 }
 
 bool IsolateCommandBuffer::empty() {
-  return size_ == 0;
+  return buffer_.size == 0;
+}
+
+bool IsolateCommandBuffer::HasPendingCommands(const NativeBindingObject* native_ptr) const {
+  return native_ptr->pending_command_epoch_ == flush_epoch_;
 }
 
 void IsolateCommandBuffer::clear() {
-  size_ = 0;
-  memset(buffer_, 0, sizeof(buffer_));
-  update_batched_ = false;
+  Buffer& buffer = buffer_;
+  int64_t used_chunks = 0;
+  for (IsolateCommandChunk* chunk = buffer.head; chunk != buffer.tail->next; chunk = chunk->next) {
+    chunk->size = 0;
+    used_chunks++;
+  }
+  buffer.tail = buffer.head;
+  buffer.size = 0;
+  buffer.bytes = 0;
+  buffer.stream.Reset();
+  TrimChunks(buffer, used_chunks);
+  buffer.retained_strings.clear();
+  flush_epoch_++;
 }
 
 }  // namespace mercury
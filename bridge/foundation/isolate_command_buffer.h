@@ -6,13 +6,19 @@
 #ifndef BRIDGE_FOUNDATION_ISOLATE_COMMAND_BUFFER_H_
 #define BRIDGE_FOUNDATION_ISOLATE_COMMAND_BUFFER_H_
 
+#include <chrono>
 #include <cinttypes>
+#include <vector>
+#include "bindings/qjs/native_string_cache.h"
 #include "bindings/qjs/native_string_utils.h"
+#include "isolate_command_stream.h"
 #include "native_value.h"
 
 namespace mercury {
 
+class AtomicString;
 class ExecutingContext;
+struct NativeBindingObject;
 
 enum class IsolateCommand {
   kCreateGlobal,
@@ -20,16 +26,61 @@ enum class IsolateCommand {
   kDisposeBindingObject,
   kAddEvent,
   kRemoveEvent,
+  // The listener summary of one event type on a target changed, see EventListenerSummary.
+  kUpdateEventListenerSummary,
 };
 
-#define MAXIMUM_ISOLATE_COMMAND_SIZE 2048
+enum class IsolateCommandFlushMode : int32_t {
+  // Request one batched flush from the Dart side on the first command after every flush.
+  kBatchUpdate = 0,
+  // Same as kBatchUpdate, and flush immediately once the pending commands exceed the thresholds of the policy.
+  kThreshold = 1,
+  // Never request flushes during a script turn, request one after the outermost script turn finished.
+  kAfterScriptTurn = 2,
+};
+
+// Selected per MercuryIsolate by the Dart side at allocateNewMercuryIsolate.
+struct IsolateCommandFlushPolicy {
+  IsolateCommandFlushMode mode{IsolateCommandFlushMode::kBatchUpdate};
+  // Thresholds for kThreshold mode, zero means no limit.
+  int32_t max_pending_items{0};
+  int64_t max_pending_bytes{0};
+};
+
+#define ISOLATE_COMMAND_TYPE_COUNT 6
+#define ISOLATE_COMMAND_LATENCY_BUCKET_COUNT 8
+
+// Statistics of the bridge traffic, read by the Dart side through getIsolateCommandTelemetry.
+struct IsolateCommandTelemetry {
+  // Commands added, indexed by IsolateCommand.
+  int64_t command_counts[ISOLATE_COMMAND_TYPE_COUNT]{};
+  int64_t flush_count{0};
+  // Bytes of the encoded command stream.
+  int64_t total_bytes{0};
+  int64_t last_flush_bytes{0};
+  int64_t max_flush_bytes{0};
+  // Maximum count of commands within one flush.
+  int64_t max_buffer_size{0};
+  double flushes_per_second{0};
+  // Flush latency in microseconds, bucketed by the upper bounds of 50, 100, 250, 500, 1000, 2500, 5000 and infinity.
+  int64_t latency_histogram[ISOLATE_COMMAND_LATENCY_BUCKET_COUNT]{};
+};
+
+// Count of commands in each chunk of the command buffer.
+#define ISOLATE_COMMAND_CHUNK_SIZE 512
+// Minimum count of chunks kept for reuse after flush.
+#define ISOLATE_COMMAND_RETAINED_CHUNKS 4
 
 struct IsolateCommandItem {
   IsolateCommandItem() = default;
-  explicit IsolateCommandItem(int32_t type, SharedNativeString* args_01, void* nativePtr, void* nativePtr2)
+  explicit IsolateCommandItem(int32_t type,
+                              const uint16_t* args_01,
+                              uint32_t args_01_length,
+                              void* nativePtr,
+                              void* nativePtr2)
       : type(type),
-        string_01(reinterpret_cast<int64_t>(args_01 != nullptr ? args_01->string() : nullptr)),
-        args_01_length(args_01 != nullptr ? args_01->length() : 0),
+        string_01(reinterpret_cast<int64_t>(args_01)),
+        args_01_length(static_cast<int32_t>(args_01_length)),
         nativePtr(reinterpret_cast<int64_t>(nativePtr)),
         nativePtr2(reinterpret_cast<int64_t>(nativePtr2)){};
   int32_t type{0};
@@ -39,29 +90,102 @@ struct IsolateCommandItem {
   int64_t nativePtr2{0};
 };
 
+struct IsolateCommandChunk {
+  IsolateCommandItem items[ISOLATE_COMMAND_CHUNK_SIZE];
+  int64_t size{0};
+  IsolateCommandChunk* next{nullptr};
+};
+
+// All access happens on the JS thread of the isolate, including the FFI entries used by the Dart side. The Dart side
+// encodes, reads and releases the pending commands within one flush, so scripts never append while Dart reads.
+// The commands are kept in a linked list of fixed size chunks. After coalescing, commands are encoded into a compact
+// variable-length stream for the Dart side, see IsolateCommandStreamWriter.
 class IsolateCommandBuffer {
  public:
   IsolateCommandBuffer() = delete;
   explicit IsolateCommandBuffer(ExecutingContext* context);
   ~IsolateCommandBuffer();
+  void addCommand(IsolateCommand type, void* nativePtr, void* nativePtr2, bool request_isolate_update = true);
+  // The string is borrowed from the NativeStringCache and retained by the pending flush until the Dart side finished
+  // reading, the stream references it by pointer.
   void addCommand(IsolateCommand type,
-                  std::unique_ptr<SharedNativeString>&& args_01,
+                  const AtomicString& args_01,
                   void* nativePtr,
                   void* nativePtr2,
                   bool request_isolate_update = true);
-  IsolateCommandItem* data();
+  // Coalesce the pending commands and encode them for the Dart side.
+  void PrepareFlush();
+  // The encoded stream of the pending commands, readable by the Dart side after PrepareFlush().
+  const uint8_t* stream();
+  int64_t streamLength();
   int64_t size();
   bool empty();
+  // Whether any pending command references the native binding object.
+  bool HasPendingCommands(const NativeBindingObject* native_ptr) const;
+  // Release the commands and their string payloads after the Dart side finished reading.
   void clear();
 
+  // Coalescing drops commands which cancel each other out before they are exposed to the Dart side.
+  void SetCoalescingEnabled(bool enabled) { coalescing_enabled_ = enabled; }
+  // The total count of commands dropped by coalescing.
+  int64_t elidedCommandCount() const { return elided_command_count_; }
+
+  void SetFlushPolicy(const IsolateCommandFlushPolicy& policy) { flush_policy_ = policy; }
+  const IsolateCommandFlushPolicy& flushPolicy() const { return flush_policy_; }
+  void EnterScriptTurn();
+  void LeaveScriptTurn();
+
+  // Record the time spent by the Dart side to handle one flush.
+  void RecordFlushLatency(int64_t microseconds);
+  const IsolateCommandTelemetry* telemetry() const { return &telemetry_; }
+
  private:
+  struct Buffer {
+    IsolateCommandChunk* head{nullptr};
+    // The chunk new commands are appended to, chunks after it are kept for reuse.
+    IsolateCommandChunk* tail{nullptr};
+    int64_t chunk_count{0};
+    int64_t size{0};
+    // Estimated bytes of the pending commands and their string payloads.
+    int64_t bytes{0};
+    // Decayed peak of the chunks used by recent flushes.
+    int64_t high_water_chunks{0};
+    IsolateCommandStreamWriter stream;
+    std::vector<CachedNativeString> retained_strings;
+  };
+
   void addCommand(const IsolateCommandItem& item, bool request_isolate_update = true);
+  void RequestBatchUpdate();
+  bool ExceedsFlushThreshold(const Buffer& buffer) const;
+  void CoalesceCommands(Buffer& buffer);
+  void EncodeCommands(Buffer& buffer);
+  void RecordFlush(Buffer& buffer);
+  // Free the spare chunks above the high water mark after flush.
+  void TrimChunks(Buffer& buffer, int64_t used_chunks);
 
   ExecutingContext* context_{nullptr};
-  IsolateCommandItem* buffer_{nullptr};
+  Buffer buffer_;
   bool update_batched_{false};
-  int64_t size_{0};
-  int64_t max_size_{MAXIMUM_ISOLATE_COMMAND_SIZE};
+  IsolateCommandFlushPolicy flush_policy_;
+  int32_t script_turn_depth_{0};
+  bool in_threshold_flush_{false};
+  bool coalescing_enabled_{true};
+  int64_t elided_command_count_{0};
+  // Stamped on the native binding objects referenced by pending commands, advanced by every clear.
+  int64_t flush_epoch_{1};
+  IsolateCommandTelemetry telemetry_;
+  std::chrono::steady_clock::time_point flush_window_start_{std::chrono::steady_clock::now()};
+  int64_t flushes_in_window_{0};
+};
+
+// Mark a script turn of the host calling into JavaScript, the turns might be nested.
+class ScriptTurnScope {
+ public:
+  explicit ScriptTurnScope(IsolateCommandBuffer* buffer) : buffer_(buffer) { buffer_->EnterScriptTurn(); }
+  ~ScriptTurnScope() { buffer_->LeaveScriptTurn(); }
+
+ private:
+  IsolateCommandBuffer* buffer_;
 };
 
 }  // namespace mercury
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "isolate_command_stream.h"
+
+namespace mercury {
+
+static constexpr size_t kRetainedStreamBytes = 64 * 1024;
+
+void IsolateCommandStreamWriter::WriteHeader(int64_t command_count) {
+  WriteVarUint(ISOLATE_COMMAND_STREAM_VERSION);
+  WriteVarUint(command_count);
+}
+
+void IsolateCommandStreamWriter::WriteVarUint(uint64_t value) {
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    bytes_.push_back(byte);
+  } while (value != 0);
+}
+
+void IsolateCommandStreamWriter::WriteVarInt(int64_t value) {
+  bool more = true;
+  while (more) {
+    uint8_t byte = value & 0x7f;
+    // Arithmetic shift keeps the sign bits.
+    value >>= 7;
+    if ((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0)) {
+      more = false;
+    } else {
+      byte |= 0x80;
+    }
+    bytes_.push_back(byte);
+  }
+}
+
+void IsolateCommandStreamWriter::WritePointer(int64_t value, int64_t* previous) {
+  // Wrap around instead of overflow when the pointers are far away from each other.
+  WriteVarInt(static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(*previous)));
+  *previous = value;
+}
+
+void IsolateCommandStreamWriter::WriteString(const uint16_t* string, uint32_t length, int64_t* previous_string) {
+  if (length > ISOLATE_COMMAND_INLINE_STRING_LENGTH) {
+    WriteStringPointer(string, length, previous_string);
+    return;
+  }
+
+  bool is_latin1 = true;
+  for (uint32_t i = 0; i < length; i++) {
+    if (string[i] > 0xff) {
+      is_latin1 = false;
+      break;
+    }
+  }
+
+  if (is_latin1) {
+    WriteVarUint(static_cast<uint64_t>(length) << 2 | static_cast<uint64_t>(IsolateCommandStringKind::kInlineLatin1));
+    for (uint32_t i = 0; i < length; i++) {
+      bytes_.push_back(static_cast<uint8_t>(string[i]));
+    }
+  } else {
+    WriteVarUint(static_cast<uint64_t>(length) << 2 | static_cast<uint64_t>(IsolateCommandStringKind::kInlineUTF16));
+    for (uint32_t i = 0; i < length; i++) {
+      bytes_.push_back(static_cast<uint8_t>(string[i] & 0xff));
+      bytes_.push_back(static_cast<uint8_t>(string[i] >> 8));
+    }
+  }
+}
+
+void IsolateCommandStreamWriter::WriteStringPointer(const uint16_t* string,
+                                                    uint32_t length,
+                                                    int64_t* previous_string) {
+  WriteVarUint(static_cast<uint64_t>(length) << 2 | static_cast<uint64_t>(IsolateCommandStringKind::kPointer));
+  WritePointer(reinterpret_cast<int64_t>(string), previous_string);
+}
+
+void IsolateCommandStreamWriter::Reset() {
+  if (bytes_.capacity() > kRetainedStreamBytes && bytes_.size() < bytes_.capacity() / 4) {
+    std::vector<uint8_t>().swap(bytes_);
+    return;
+  }
+  bytes_.clear();
+}
+
+}  // namespace mercury
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_ISOLATE_COMMAND_STREAM_H_
+#define BRIDGE_FOUNDATION_ISOLATE_COMMAND_STREAM_H_
+
+#include <cinttypes>
+#include <cstddef>
+#include <vector>
+
+namespace mercury {
+
+// Bump this version when the layout of the stream changes, the Dart side rejects the stream of other versions.
+#define ISOLATE_COMMAND_STREAM_VERSION 3
+// Strings not longer than this are copied into the stream, the longer ones are referenced by pointer.
+#define ISOLATE_COMMAND_INLINE_STRING_LENGTH 32
+
+// The kind of string payloads, stored in the lower 2 bits of the string header.
+enum class IsolateCommandStringKind {
+  kInlineLatin1 = 0,
+  kInlineUTF16 = 1,
+  kPointer = 2,
+};
+
+// Variable-length encoding of the isolate commands read by the Dart side:
+//
+//   stream  := version:uleb count:uleb command*
+//   command := opcode:uleb operands
+//   pointer := sleb (delta against the previous pointer of the same operand)
+//   string  := header:uleb (length << 2 | kind) payload
+//
+// Payload of inline latin1 strings are one byte per character, and two bytes in little-endian for inline UTF-16
+// strings. Pointer strings carry a pointer operand to the UTF-16 characters instead.
+class IsolateCommandStreamWriter {
+ public:
+  IsolateCommandStreamWriter() = default;
+
+  void WriteHeader(int64_t command_count);
+  void WriteVarUint(uint64_t value);
+  void WriteVarInt(int64_t value);
+  // Write the difference against the previous value, and replace the previous value with the current one.
+  void WritePointer(int64_t value, int64_t* previous);
+  void WriteString(const uint16_t* string, uint32_t length, int64_t* previous_string);
+  // Reference the characters by pointer whatever the length, for strings which outlive the read of the stream.
+  void WriteStringPointer(const uint16_t* string, uint32_t length, int64_t* previous_string);
+
+  const uint8_t* data() const { return bytes_.data(); }
+  int64_t length() const { return static_cast<int64_t>(bytes_.size()); }
+
+  // Drop the encoded bytes, the storage are released if it was grown by a burst of commands and mostly unused.
+  void Reset();
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_ISOLATE_COMMAND_STREAM_H_
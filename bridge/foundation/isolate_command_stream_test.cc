@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "isolate_command_stream.h"
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+static std::vector<uint8_t> ToBytes(const IsolateCommandStreamWriter& writer) {
+  return std::vector<uint8_t>(writer.data(), writer.data() + writer.length());
+}
+
+TEST(IsolateCommandStream, writeHeader) {
+  IsolateCommandStreamWriter writer;
+  writer.WriteHeader(300);
+  EXPECT_EQ(ToBytes(writer), std::vector<uint8_t>({ISOLATE_COMMAND_STREAM_VERSION, 0xac, 0x02}));
+}
+
+TEST(IsolateCommandStream, writeVarInt) {
+  IsolateCommandStreamWriter writer;
+  writer.WriteVarInt(63);
+  writer.WriteVarInt(-64);
+  writer.WriteVarInt(64);
+  writer.WriteVarInt(-65);
+  EXPECT_EQ(ToBytes(writer), std::vector<uint8_t>({0x3f, 0x40, 0xc0, 0x00, 0xbf, 0x7f}));
+}
+
+TEST(IsolateCommandStream, pointerDelta) {
+  IsolateCommandStreamWriter writer;
+  int64_t previous = 0;
+  writer.WritePointer(0x1000, &previous);
+  writer.WritePointer(0x1020, &previous);
+  writer.WritePointer(0x1000, &previous);
+  EXPECT_EQ(previous, 0x1000);
+  EXPECT_EQ(ToBytes(writer), std::vector<uint8_t>({0x80, 0x20, 0x20, 0x60}));
+}
+
+TEST(IsolateCommandStream, inlineStrings) {
+  IsolateCommandStreamWriter writer;
+  int64_t previous_string = 0;
+  uint16_t latin1[] = {'c', 'l', 'i', 'c', 'k'};
+  uint16_t utf16[] = {0x4f60, 'a'};
+  writer.WriteString(latin1, 5, &previous_string);
+  writer.WriteString(utf16, 2, &previous_string);
+  EXPECT_EQ(previous_string, 0);
+  EXPECT_EQ(ToBytes(writer),
+            std::vector<uint8_t>({5 << 2, 'c', 'l', 'i', 'c', 'k', 2 << 2 | 1, 0x60, 0x4f, 'a', 0x00}));
+}
+
+TEST(IsolateCommandStream, pointerStrings) {
+  IsolateCommandStreamWriter writer;
+  int64_t previous_string = 0;
+  std::vector<uint16_t> string(ISOLATE_COMMAND_INLINE_STRING_LENGTH + 1, 'a');
+  writer.WriteString(string.data(), string.size(), &previous_string);
+  EXPECT_EQ(previous_string, reinterpret_cast<int64_t>(string.data()));
+  uint64_t header = (ISOLATE_COMMAND_INLINE_STRING_LENGTH + 1) << 2 | 2;
+  EXPECT_EQ(writer.data()[0], (header & 0x7f) | 0x80);
+  EXPECT_EQ(writer.data()[1], header >> 7);
+}
+
+TEST(IsolateCommandStream, borrowedStrings) {
+  IsolateCommandStreamWriter writer;
+  int64_t previous_string = 0;
+  uint16_t click[] = {'c', 'l', 'i', 'c', 'k'};
+  writer.WriteStringPointer(click, 5, &previous_string);
+  EXPECT_EQ(previous_string, reinterpret_cast<int64_t>(click));
+  EXPECT_EQ(writer.data()[0], 5 << 2 | 2);
+}
@@ -5,6 +5,7 @@
 #include "native_value.h"
 #include "bindings/qjs/qjs_engine_patch.h"
 #include "bindings/qjs/script_value.h"
+#include "bindings/qjs/structured_clone.h"
 #include "core/executing_context.h"
 
 namespace mercury {
@@ -43,6 +44,19 @@ NativeValue Native_NewCString(const std::string& string) {
   return Native_NewString(nativeString.release());
 }
 
+NativeValue Native_NewLatin1String(const uint8_t* characters, uint32_t length) {
+#ifdef _MSC_VER
+  NativeValue v{};
+  v.u.ptr = const_cast<uint8_t*>(characters);
+  v.uint32 = length;
+  v.tag = NativeTag::TAG_LATIN1_STRING;
+  return v;
+#else
+  return (NativeValue){
+      .u = {.ptr = const_cast<uint8_t*>(characters)}, .uint32 = length, .tag = NativeTag::TAG_LATIN1_STRING};
+#endif
+}
+
 NativeValue Native_NewFloat64(double value) {
   int64_t result;
   memcpy(&result, reinterpret_cast<void*>(&value), sizeof(double));
@@ -74,6 +88,17 @@ NativeValue Native_NewPtr(JSPointerType pointerType, void* ptr) {
 #endif
 }
 
+NativeValue Native_NewTypedArray(NativeTypedArray* typed_array) {
+#if _MSC_VER
+  NativeValue v{};
+  v.u.ptr = typed_array;
+  v.tag = NativeTag::TAG_TYPED_ARRAY;
+  return v;
+#else
+  return (NativeValue){.u = {.ptr = typed_array}, .uint32 = 0, .tag = NativeTag::TAG_TYPED_ARRAY};
+#endif
+}
+
 NativeValue Native_NewBool(bool value) {
 #if _MSC_VER
   NativeValue v{};
@@ -142,4 +167,30 @@ NativeValue Native_NewJSON(JSContext* ctx, const ScriptValue& value, ExceptionSt
 #endif
 }
 
+NativeValue Native_NewStructuredClone(JSContext* ctx, const ScriptValue& value, ExceptionState& exception_state) {
+  StructuredCloneWriter writer(ctx);
+  if (!writer.Write(value.QJSValue())) {
+    exception_state.ThrowException(ctx, JS_EXCEPTION);
+    return Native_NewNull();
+  }
+
+  auto* bytes = static_cast<uint8_t*>(malloc(writer.length()));
+  memcpy(bytes, writer.data(), writer.length());
+
+#if _MSC_VER
+  NativeValue v{};
+  v.u.ptr = static_cast<void*>(bytes);
+  v.uint32 = writer.length();
+  v.tag = NativeTag::TAG_STRUCTURED_CLONE;
+  return v;
+#else
+  NativeValue result = (NativeValue){
+      .u = {.ptr = static_cast<void*>(bytes)},
+      .uint32 = writer.length(),
+      .tag = NativeTag::TAG_STRUCTURED_CLONE,
+  };
+  return result;
+#endif
+}
+
 }  // namespace mercury
@@ -26,6 +26,16 @@ enum NativeTag {
   TAG_FUNCTION = 8,
   TAG_ASYNC_FUNCTION = 9,
   TAG_UINT8_BYTES = 10,
+  TAG_TYPED_ARRAY = 11,
+  TAG_STRUCTURED_CLONE = 12,
+  // Packed lists of numbers allocated by dart, the length is saved in uint32.
+  TAG_FLOAT64_LIST = 13,
+  TAG_INT32_LIST = 14,
+  TAG_INT64_LIST = 15,
+  TAG_BOOL_LIST = 16,
+  // One-byte characters borrowed from a JSString which is alive during the call, the length is saved in uint32.
+  // Dart copies them out and never frees the pointer.
+  TAG_LATIN1_STRING = 17,
 };
 
 enum class JSPointerType { NativeBindingObject = 0, Others = 1 };
@@ -45,6 +55,30 @@ struct NativeValue {
   int32_t tag;
 };
 
+enum class NativeTypedArrayType : int32_t {
+  kArrayBuffer = 0,
+  kInt8,
+  kUint8,
+  kUint8Clamped,
+  kInt16,
+  kUint16,
+  kInt32,
+  kUint32,
+  kFloat32,
+  kFloat64,
+};
+
+// Backing store of an ArrayBuffer or typed array shared with dart without copying. The record is owned by the
+// NativeTypedArrayRegistry of the dart isolate, the bytes stay valid until dart finalized its view and released the
+// record by |id|, even after the context is disposed.
+struct NativeTypedArray {
+  uint8_t* bytes;
+  int64_t byte_length;
+  int32_t type;
+  // Unique in the dart isolate, so a stale id from dart never matches a newer record.
+  int64_t id;
+};
+
 struct NativeFunctionContext;
 
 using CallNativeFunction = void (*)(NativeFunctionContext* functionContext,
@@ -70,12 +104,16 @@ struct NativeFunctionContext {
 NativeValue Native_NewNull();
 NativeValue Native_NewString(SharedNativeString* string);
 NativeValue Native_NewCString(const std::string& string);
+NativeValue Native_NewLatin1String(const uint8_t* characters, uint32_t length);
 NativeValue Native_NewFloat64(double value);
 NativeValue Native_NewBool(bool value);
 NativeValue Native_NewInt64(int64_t value);
 NativeValue Native_NewList(uint32_t argc, NativeValue* argv);
 NativeValue Native_NewPtr(JSPointerType pointerType, void* ptr);
+NativeValue Native_NewTypedArray(NativeTypedArray* typed_array);
 NativeValue Native_NewJSON(JSContext* ctx, const ScriptValue& value, ExceptionState& exception_state);
+// The serialized bytes are allocated by malloc and the length is saved in uint32.
+NativeValue Native_NewStructuredClone(JSContext* ctx, const ScriptValue& value, ExceptionState& exception_state);
 
 }  // namespace mercury
 
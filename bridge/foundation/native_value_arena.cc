@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "native_value_arena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "bindings/qjs/qjs_engine_patch.h"
+#include "native_string.h"
+
+namespace mercury {
+
+NativeValueArena::~NativeValueArena() {
+  for (RetainedValue* retained = retained_values_; retained != nullptr; retained = retained->next) {
+    JS_FreeValueRT(runtime_, retained->value);
+  }
+  for (void* chunk : chunks_) {
+    free(chunk);
+  }
+}
+
+void* NativeValueArena::Allocate(size_t size, size_t alignment) {
+  auto address = reinterpret_cast<uintptr_t>(cursor_);
+  uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+  if (aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+    size_t chunk_size = std::max(next_chunk_size_, size + alignment);
+    auto* chunk = static_cast<uint8_t*>(malloc(chunk_size));
+    chunks_.push_back(chunk);
+    cursor_ = chunk;
+    end_ = chunk + chunk_size;
+    next_chunk_size_ *= 2;
+    address = reinterpret_cast<uintptr_t>(cursor_);
+    aligned = (address + alignment - 1) & ~(alignment - 1);
+  }
+  cursor_ = reinterpret_cast<uint8_t*>(aligned + size);
+  return reinterpret_cast<void*>(aligned);
+}
+
+NativeValue* NativeValueArena::AllocateValues(size_t count) {
+  return static_cast<NativeValue*>(Allocate(sizeof(NativeValue) * count, alignof(NativeValue)));
+}
+
+NativeValue NativeValueArena::NewString(const uint16_t* characters, uint32_t length) {
+  auto* buffer = static_cast<uint16_t*>(Allocate(sizeof(uint16_t) * length, alignof(uint16_t)));
+  memcpy(buffer, characters, sizeof(uint16_t) * length);
+  // The class allocator of SharedNativeString is bypassed, the arena owns the memory.
+  auto* string = ::new (Allocate(sizeof(SharedNativeString), alignof(SharedNativeString)))
+      SharedNativeString(buffer, length);
+  return Native_NewString(string);
+}
+
+NativeValue NativeValueArena::NewLatin1String(JSContext* ctx, JSValueConst string) {
+  runtime_ = JS_GetRuntime(ctx);
+  auto* retained = static_cast<RetainedValue*>(Allocate(sizeof(RetainedValue), alignof(RetainedValue)));
+  retained->value = JS_DupValue(ctx, string);
+  retained->next = retained_values_;
+  retained_values_ = retained;
+
+  JSString* p = JS_VALUE_GET_STRING(string);
+  return Native_NewLatin1String(p->u.str8, p->len);
+}
+
+NativeValue NativeValueArena::NewCString(const std::string& string) {
+  // Transcode into the arena directly, the count of bytes is the upper bound of code units.
+  auto* buffer = static_cast<uint16_t*>(Allocate(sizeof(uint16_t) * string.size(), alignof(uint16_t)));
+  size_t length = ConvertUTF8ToUTF16(string.data(), string.size(), buffer);
+  auto* native_string = ::new (Allocate(sizeof(SharedNativeString), alignof(SharedNativeString)))
+      SharedNativeString(buffer, length);
+  return Native_NewString(native_string);
+}
+
+NativeValue NativeValueArena::NewBytes(NativeTag tag, const uint8_t* bytes, uint32_t length) {
+  auto* buffer = static_cast<uint8_t*>(Allocate(length, 1));
+  memcpy(buffer, bytes, length);
+  NativeValue value = Native_NewNull();
+  value.u.ptr = buffer;
+  value.uint32 = length;
+  value.tag = tag;
+  return value;
+}
+
+}  // namespace mercury
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_NATIVE_VALUE_ARENA_H_
+#define BRIDGE_FOUNDATION_NATIVE_VALUE_ARENA_H_
+
+#include <cinttypes>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "native_value.h"
+
+namespace mercury {
+
+// Bump allocator which holds the NativeValue tree of one synchronous call to dart: the list storage, the strings and
+// the structured clone payloads. The dart side reads the values without freeing them, and the whole tree is released
+// at once when the arena goes out of scope after the call returns.
+//
+// Values which dart keeps after the call (typed arrays and pointers) are not allocated in the arena.
+class NativeValueArena {
+ public:
+  NativeValueArena() = default;
+  ~NativeValueArena();
+  NativeValueArena(const NativeValueArena&) = delete;
+  NativeValueArena& operator=(const NativeValueArena&) = delete;
+
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+  NativeValue* AllocateValues(size_t count);
+  // Copy the characters into a SharedNativeString owned by the arena.
+  NativeValue NewString(const uint16_t* characters, uint32_t length);
+  // Borrow the characters of a one-byte JSString, which is retained until the arena is released.
+  NativeValue NewLatin1String(JSContext* ctx, JSValueConst string);
+  NativeValue NewCString(const std::string& string);
+  NativeValue NewBytes(NativeTag tag, const uint8_t* bytes, uint32_t length);
+
+ private:
+  // Most of calls carry a few short arguments, which fit in the inline chunk without any malloc.
+  static constexpr size_t kInlineChunkSize = 1024;
+  static constexpr size_t kMinChunkSize = 4096;
+
+  alignas(std::max_align_t) uint8_t inline_chunk_[kInlineChunkSize];
+  uint8_t* cursor_{inline_chunk_};
+  uint8_t* end_{inline_chunk_ + kInlineChunkSize};
+  size_t next_chunk_size_{kMinChunkSize};
+  std::vector<void*> chunks_;
+  // Linked in the arena memory.
+  struct RetainedValue {
+    JSValue value;
+    RetainedValue* next;
+  };
+  JSRuntime* runtime_{nullptr};
+  RetainedValue* retained_values_{nullptr};
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_NATIVE_VALUE_ARENA_H_
@@ -37,6 +37,13 @@ struct NativeValueConverter<NativeTypeString> : public NativeValueConverterBase<
     return Native_NewString(value.ToNativeString(ctx).release());
   }
   static NativeValue ToNativeValue(const std::string& value) { return Native_NewCString(value); }
+  // One-byte strings are borrowed from the atom without widening, the value must stay alive until dart returns.
+  static NativeValue ToBorrowedNativeValue(JSContext* ctx, const ImplType& value) {
+    if (!value.IsNull() && !JS_AtomIsTaggedInt(value.Impl()) && value.Is8Bit()) {
+      return Native_NewLatin1String(value.Character8(), value.length());
+    }
+    return ToNativeValue(ctx, value);
+  }
 
   static ImplType FromNativeValue(JSContext* ctx, NativeValue&& value) {
     if (value.tag == NativeTag::TAG_NULL) {
@@ -90,9 +97,12 @@ struct NativeValueConverter<NativeTypeDouble> : public NativeValueConverterBase<
 template <>
 struct NativeValueConverter<NativeTypeJSON> : public NativeValueConverterBase<NativeTypeJSON> {
   static NativeValue ToNativeValue(JSContext* ctx, ImplType value, ExceptionState& exception_state) {
-    return Native_NewJSON(ctx, value, exception_state);
+    return Native_NewStructuredClone(ctx, value, exception_state);
   }
   static ImplType FromNativeValue(JSContext* ctx, NativeValue value) {
+    if (value.tag == NativeTag::TAG_STRUCTURED_CLONE) {
+      return ScriptValue::CreateFromStructuredClone(ctx, static_cast<const uint8_t*>(value.u.ptr), value.uint32);
+    }
     assert(value.tag == NativeTag::TAG_JSON);
     auto* str = static_cast<const char*>(value.u.ptr);
     return ScriptValue::CreateJsonObject(ctx, str, strlen(str));
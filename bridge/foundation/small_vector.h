@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_SMALL_VECTOR_H_
+#define BRIDGE_FOUNDATION_SMALL_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace mercury {
+
+// A vector which keeps up to |InlineCapacity| elements inside itself and only moves them to the heap when it grows
+// past that. Meant for small collections which are created often, such as the event listeners of one target.
+// Unlike std::vector, moving a SmallVector with inline elements moves the elements themselves, so pointers into it do
+// not survive a move of the container.
+template <typename T, size_t InlineCapacity>
+class SmallVector final {
+  static_assert(InlineCapacity > 0, "Use std::vector for containers without inline storage.");
+
+ public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  SmallVector() = default;
+  SmallVector(const SmallVector&) = delete;
+  SmallVector& operator=(const SmallVector&) = delete;
+  SmallVector(SmallVector&& other) noexcept { MoveFrom(std::move(other)); }
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      clear();
+      FreeHeapBuffer();
+      MoveFrom(std::move(other));
+    }
+    return *this;
+  }
+  ~SmallVector() {
+    clear();
+    FreeHeapBuffer();
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+  bool IsInline() const { return data_ == InlineBuffer(); }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  T& operator[](size_t index) {
+    assert(index < size_);
+    return data_[index];
+  }
+  const T& operator[](size_t index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+  T& back() {
+    assert(size_ > 0);
+    return data_[size_ - 1];
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      // Construct first, the arguments may refer to an element which is about to be moved.
+      T value(std::forward<Args>(args)...);
+      Grow(capacity_ * 2);
+      return *new (data_ + size_++) T(std::move(value));
+    }
+    return *new (data_ + size_++) T(std::forward<Args>(args)...);
+  }
+
+  iterator erase(iterator position) {
+    assert(position >= begin() && position < end());
+    for (iterator it = position; it + 1 != end(); ++it) {
+      *it = std::move(*(it + 1));
+    }
+    data_[--size_].~T();
+    return position;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < size_; i++) {
+      data_[i].~T();
+    }
+    size_ = 0;
+  }
+
+ private:
+  T* InlineBuffer() { return reinterpret_cast<T*>(inline_buffer_); }
+  const T* InlineBuffer() const { return reinterpret_cast<const T*>(inline_buffer_); }
+
+  void Grow(size_t new_capacity) {
+    T* buffer = static_cast<T*>(malloc(sizeof(T) * new_capacity));
+    for (size_t i = 0; i < size_; i++) {
+      new (buffer + i) T(std::move(data_[i]));
+      data_[i].~T();
+    }
+    FreeHeapBuffer();
+    data_ = buffer;
+    capacity_ = static_cast<uint32_t>(new_capacity);
+  }
+
+  void FreeHeapBuffer() {
+    if (!IsInline()) {
+      free(data_);
+      data_ = InlineBuffer();
+      capacity_ = InlineCapacity;
+    }
+  }
+
+  // Expects this to be empty and inline.
+  void MoveFrom(SmallVector&& other) {
+    if (other.IsInline()) {
+      for (size_t i = 0; i < other.size_; i++) {
+        new (data_ + i) T(std::move(other.data_[i]));
+      }
+      size_ = other.size_;
+      other.clear();
+      return;
+    }
+    // Take over the heap buffer.
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.data_ = other.InlineBuffer();
+    other.size_ = 0;
+    other.capacity_ = InlineCapacity;
+  }
+
+  T* data_{InlineBuffer()};
+  uint32_t size_{0};
+  uint32_t capacity_{InlineCapacity};
+  alignas(T) unsigned char inline_buffer_[sizeof(T) * InlineCapacity];
+};
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_SMALL_VECTOR_H_
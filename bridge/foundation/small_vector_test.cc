@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "small_vector.h"
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+TEST(SmallVector, staysInlineUpToCapacity) {
+  SmallVector<std::string, 2> vector;
+  vector.push_back("a");
+  vector.emplace_back("b");
+  EXPECT_TRUE(vector.IsInline());
+  EXPECT_EQ(vector.size(), 2);
+
+  vector.push_back("c");
+  EXPECT_FALSE(vector.IsInline());
+  EXPECT_EQ(vector[0], "a");
+  EXPECT_EQ(vector[1], "b");
+  EXPECT_EQ(vector[2], "c");
+}
+
+TEST(SmallVector, pushBackElementOfItself) {
+  SmallVector<std::string, 1> vector;
+  vector.push_back("a long string which does not fit the small string buffer");
+  vector.push_back(vector[0]);
+  EXPECT_EQ(vector[1], vector[0]);
+}
+
+TEST(SmallVector, erase) {
+  SmallVector<std::shared_ptr<int>, 2> vector;
+  auto value = std::make_shared<int>(1);
+  vector.push_back(std::make_shared<int>(0));
+  vector.push_back(value);
+  vector.push_back(std::make_shared<int>(2));
+
+  auto it = vector.erase(vector.begin() + 1);
+  EXPECT_EQ(**it, 2);
+  EXPECT_EQ(vector.size(), 2);
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(SmallVector, move) {
+  SmallVector<std::shared_ptr<int>, 2> inline_vector;
+  auto value = std::make_shared<int>(1);
+  inline_vector.push_back(value);
+  SmallVector<std::shared_ptr<int>, 2> moved_inline(std::move(inline_vector));
+  EXPECT_TRUE(inline_vector.empty());
+  EXPECT_EQ(moved_inline[0], value);
+
+  SmallVector<std::shared_ptr<int>, 2> heap_vector;
+  for (int i = 0; i < 3; i++) {
+    heap_vector.push_back(value);
+  }
+  moved_inline = std::move(heap_vector);
+  EXPECT_TRUE(heap_vector.empty());
+  EXPECT_TRUE(heap_vector.IsInline());
+  EXPECT_EQ(moved_inline.size(), 3);
+  EXPECT_EQ(value.use_count(), 4);
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "utf_transcoding.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF_TRANSCODING_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define UTF_TRANSCODING_NEON 1
+#endif
+
+namespace mercury {
+
+static constexpr uint16_t kReplacementCharacter = 0xFFFD;
+static constexpr size_t kBlockSize = 16;
+
+static inline bool IsLeadSurrogate(uint16_t c) {
+  return (c & 0xFC00) == 0xD800;
+}
+
+static inline bool IsTrailSurrogate(uint16_t c) {
+  return (c & 0xFC00) == 0xDC00;
+}
+
+// Return true if the 16 code units are all ASCII.
+static inline bool IsASCIIBlock(const uint16_t* source) {
+#if UTF_TRANSCODING_SSE2
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 8));
+  __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<int16_t>(0xFF80)));
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF;
+#elif UTF_TRANSCODING_NEON
+  uint16x8_t units = vorrq_u16(vld1q_u16(source), vld1q_u16(source + 8));
+  return vmaxvq_u16(units) < 0x80;
+#else
+  uint16_t units = 0;
+  for (size_t i = 0; i < kBlockSize; i++) {
+    units |= source[i];
+  }
+  return units < 0x80;
+#endif
+}
+
+// Narrow 16 ASCII code units to bytes.
+static inline void NarrowASCIIBlock(const uint16_t* source, char* destination) {
+#if UTF_TRANSCODING_SSE2
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_packus_epi16(a, b));
+#elif UTF_TRANSCODING_NEON
+  uint8x16_t bytes = vcombine_u8(vmovn_u16(vld1q_u16(source)), vmovn_u16(vld1q_u16(source + 8)));
+  vst1q_u8(reinterpret_cast<uint8_t*>(destination), bytes);
+#else
+  for (size_t i = 0; i < kBlockSize; i++) {
+    destination[i] = static_cast<char>(source[i]);
+  }
+#endif
+}
+
+// Widen 16 bytes to code units if they are all ASCII, return false otherwise.
+static inline bool WidenASCIIBlock(const char* source, uint16_t* destination) {
+#if UTF_TRANSCODING_SSE2
+  __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+  if (_mm_movemask_epi8(bytes) != 0)
+    return false;
+  __m128i zero = _mm_setzero_si128();
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi8(bytes, zero));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 8), _mm_unpackhi_epi8(bytes, zero));
+  return true;
+#elif UTF_TRANSCODING_NEON
+  uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(source));
+  if (vmaxvq_u8(bytes) >= 0x80)
+    return false;
+  vst1q_u16(destination, vmovl_u8(vget_low_u8(bytes)));
+  vst1q_u16(destination + 8, vmovl_u8(vget_high_u8(bytes)));
+  return true;
+#else
+  uint8_t bits = 0;
+  for (size_t i = 0; i < kBlockSize; i++) {
+    bits |= static_cast<uint8_t>(source[i]);
+  }
+  if (bits >= 0x80)
+    return false;
+  for (size_t i = 0; i < kBlockSize; i++) {
+    destination[i] = static_cast<uint8_t>(source[i]);
+  }
+  return true;
+#endif
+}
+
+size_t UTF8LengthOfUTF16(const uint16_t* source, size_t length) {
+  size_t result = 0;
+  size_t i = 0;
+  while (i < length) {
+    if (i + kBlockSize <= length && IsASCIIBlock(source + i)) {
+      result += kBlockSize;
+      i += kBlockSize;
+      continue;
+    }
+
+    uint16_t c = source[i++];
+    if (c < 0x80) {
+      result += 1;
+    } else if (c < 0x800) {
+      result += 2;
+    } else if (IsLeadSurrogate(c) && i < length && IsTrailSurrogate(source[i])) {
+      result += 4;
+      i++;
+    } else {
+      // Including lone surrogates, which are replaced by U+FFFD.
+      result += 3;
+    }
+  }
+  return result;
+}
+
+bool UTF16ToUTF8FitsInPlace(const uint16_t* source, size_t length, size_t* utf8_length) {
+  size_t result = 0;
+  size_t i = 0;
+  while (i < length) {
+    if (i + kBlockSize <= length && IsASCIIBlock(source + i)) {
+      result += kBlockSize;
+      i += kBlockSize;
+      continue;
+    }
+
+    uint16_t c = source[i++];
+    if (c < 0x80) {
+      result += 1;
+    } else if (c < 0x800) {
+      result += 2;
+    } else if (IsLeadSurrogate(c) && i < length && IsTrailSurrogate(source[i])) {
+      result += 4;
+      i++;
+    } else {
+      result += 3;
+    }
+    // The bytes written so far must stay below the first unread code unit.
+    if (result > i * sizeof(uint16_t))
+      return false;
+  }
+  if (result >= length * sizeof(uint16_t))
+    return false;
+  *utf8_length = result;
+  return true;
+}
+
+size_t ConvertUTF16ToUTF8(const uint16_t* source, size_t length, char* destination) {
+  char* out = destination;
+  size_t i = 0;
+  while (i < length) {
+    if (i + kBlockSize <= length && IsASCIIBlock(source + i)) {
+      NarrowASCIIBlock(source + i, out);
+      out += kBlockSize;
+      i += kBlockSize;
+      continue;
+    }
+
+    uint32_t c = source[i++];
+    if (c < 0x80) {
+      *out++ = static_cast<char>(c);
+      continue;
+    }
+    if (c < 0x800) {
+      *out++ = static_cast<char>(0xC0 | (c >> 6));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+      continue;
+    }
+    if (IsLeadSurrogate(c) && i < length && IsTrailSurrogate(source[i])) {
+      c = 0x10000 + ((c - 0xD800) << 10) + (source[i++] - 0xDC00);
+      *out++ = static_cast<char>(0xF0 | (c >> 18));
+      *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+      *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+      continue;
+    }
+    if (IsLeadSurrogate(c) || IsTrailSurrogate(c)) {
+      c = kReplacementCharacter;
+    }
+    *out++ = static_cast<char>(0xE0 | (c >> 12));
+    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+  }
+  return out - destination;
+}
+
+static inline bool IsContinuationByte(uint8_t c) {
+  return (c & 0xC0) == 0x80;
+}
+
+size_t ConvertUTF8ToUTF16(const char* source, size_t length, uint16_t* destination) {
+  auto* bytes = reinterpret_cast<const uint8_t*>(source);
+  uint16_t* out = destination;
+  size_t i = 0;
+  while (i < length) {
+    if (i + kBlockSize <= length && WidenASCIIBlock(source + i, out)) {
+      out += kBlockSize;
+      i += kBlockSize;
+      continue;
+    }
+
+    uint8_t c = bytes[i];
+    if (c < 0x80) {
+      *out++ = c;
+      i++;
+      continue;
+    }
+
+    // Decode one multi-byte sequence, rejecting overlong forms, surrogates and code points beyond U+10FFFF.
+    uint32_t code_point = 0;
+    size_t sequence_length = 0;
+    uint32_t min_code_point = 0;
+    if ((c & 0xE0) == 0xC0) {
+      code_point = c & 0x1F;
+      sequence_length = 2;
+      min_code_point = 0x80;
+    } else if ((c & 0xF0) == 0xE0) {
+      code_point = c & 0x0F;
+      sequence_length = 3;
+      min_code_point = 0x800;
+    } else if ((c & 0xF8) == 0xF0) {
+      code_point = c & 0x07;
+      sequence_length = 4;
+      min_code_point = 0x10000;
+    }
+
+    bool valid = sequence_length != 0 && i + sequence_length <= length;
+    for (size_t j = 1; valid && j < sequence_length; j++) {
+      valid = IsContinuationByte(bytes[i + j]);
+      code_point = (code_point << 6) | (bytes[i + j] & 0x3F);
+    }
+    valid = valid && code_point >= min_code_point && code_point <= 0x10FFFF &&
+            !(code_point >= 0xD800 && code_point <= 0xDFFF);
+
+    if (!valid) {
+      *out++ = kReplacementCharacter;
+      i++;
+      continue;
+    }
+
+    i += sequence_length;
+    if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      *out++ = static_cast<uint16_t>(0xD800 + (code_point >> 10));
+      *out++ = static_cast<uint16_t>(0xDC00 + (code_point & 0x3FF));
+    } else {
+      *out++ = static_cast<uint16_t>(code_point);
+    }
+  }
+  return out - destination;
+}
+
+}  // namespace mercury
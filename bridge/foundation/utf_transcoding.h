@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#ifndef BRIDGE_FOUNDATION_UTF_TRANSCODING_H_
+#define BRIDGE_FOUNDATION_UTF_TRANSCODING_H_
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace mercury {
+
+// Transcoding between UTF-8 and UTF-16 straight into the destination buffer. Runs of ASCII are converted 16 code units
+// at a time with SSE2 on x86_64 and NEON on arm64, the rest falls back to the scalar path. Lone surrogates and
+// malformed UTF-8 sequences are replaced by U+FFFD.
+
+// The exact count of UTF-8 bytes needed to encode the UTF-16 string.
+size_t UTF8LengthOfUTF16(const uint16_t* source, size_t length);
+// The destination must have room for UTF8LengthOfUTF16() bytes, return the count of bytes written.
+// The destination may alias the source when UTF16ToUTF8FitsInPlace() returns true.
+size_t ConvertUTF16ToUTF8(const uint16_t* source, size_t length, char* destination);
+// Return true if the UTF-8 encoding and a terminating NUL can be written over the UTF-16 source while converting front
+// to back, i.e. the output never overtakes the unread input. That holds for mostly ASCII text such as script bundles.
+// Store the UTF-8 length on success.
+bool UTF16ToUTF8FitsInPlace(const uint16_t* source, size_t length, size_t* utf8_length);
+// The destination must have room for |length| code units, which is the upper bound of the result.
+// Return the count of code units written.
+size_t ConvertUTF8ToUTF16(const char* source, size_t length, uint16_t* destination);
+
+}  // namespace mercury
+
+#endif  // BRIDGE_FOUNDATION_UTF_TRANSCODING_H_
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+#include "utf_transcoding.h"
+#include <string>
+#include "gtest/gtest.h"
+
+using namespace mercury;
+
+static std::string ToUTF8(const std::u16string& source) {
+  auto* units = reinterpret_cast<const uint16_t*>(source.data());
+  std::string result(UTF8LengthOfUTF16(units, source.size()), '\0');
+  EXPECT_EQ(ConvertUTF16ToUTF8(units, source.size(), &result[0]), result.size());
+  return result;
+}
+
+static std::u16string FromUTF8(const std::string& source) {
+  std::u16string result(source.size(), u'\0');
+  result.resize(ConvertUTF8ToUTF16(source.data(), source.size(), reinterpret_cast<uint16_t*>(&result[0])));
+  return result;
+}
+
+TEST(UTFTranscoding, roundTrip) {
+  // Long enough to take the block path before and after the non-ASCII characters.
+  std::u16string source = u"function main() { return 1; } // 你好, 😀 and ASCII again until the end of the block";
+  std::string utf8 = ToUTF8(source);
+  EXPECT_EQ(utf8, "function main() { return 1; } // 你好, 😀 and ASCII again until the end of the block");
+  EXPECT_EQ(FromUTF8(utf8), source);
+}
+
+TEST(UTFTranscoding, loneSurrogates) {
+  std::u16string source = {u'a', 0xD800, u'b', 0xDC00};
+  EXPECT_EQ(ToUTF8(source), "a\xEF\xBF\xBD"
+                            "b\xEF\xBF\xBD");
+}
+
+TEST(UTFTranscoding, malformedUTF8) {
+  // Truncated sequence, overlong encoding and encoded surrogate.
+  EXPECT_EQ(FromUTF8("a\xE4\xBD"), std::u16string({u'a', 0xFFFD, 0xFFFD}));
+  EXPECT_EQ(FromUTF8("\xC0\xAF"), std::u16string({0xFFFD, 0xFFFD}));
+  EXPECT_EQ(FromUTF8("\xED\xA0\x80"), std::u16string({0xFFFD, 0xFFFD, 0xFFFD}));
+}
+
+TEST(UTFTranscoding, inPlace) {
+  std::u16string source = u"const greeting = '你好'; // mostly ASCII source converted over itself";
+  std::string expected = ToUTF8(source);
+  size_t utf8_length;
+  ASSERT_TRUE(UTF16ToUTF8FitsInPlace(reinterpret_cast<const uint16_t*>(source.data()), source.size(), &utf8_length));
+  EXPECT_EQ(utf8_length, expected.size());
+  auto* buffer = reinterpret_cast<char*>(&source[0]);
+  ConvertUTF16ToUTF8(reinterpret_cast<const uint16_t*>(source.data()), source.size(), buffer);
+  EXPECT_EQ(std::string(buffer, utf8_length), expected);
+
+  // Three UTF-8 bytes per code unit would overtake the unread input.
+  std::u16string cjk = u"你好你好";
+  EXPECT_FALSE(UTF16ToUTF8FitsInPlace(reinterpret_cast<const uint16_t*>(cjk.data()), cjk.size(), &utf8_length));
+}
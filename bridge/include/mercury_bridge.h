@@ -33,7 +33,7 @@ typedef void (*Task)(void*);
 MERCURY_EXPORT_C
 void* initDartIsolateContext(uint64_t* dart_methods, int32_t dart_methods_len);
 MERCURY_EXPORT_C
-void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercury_isolate_id);
+void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercury_isolate_id, void* flush_policy);
 
 MERCURY_EXPORT_C
 int64_t newMercuryIsolateId();
@@ -59,11 +59,25 @@ MERCURY_EXPORT_C
 MercuryInfo* getMercuryInfo();
 
 MERCURY_EXPORT_C
-void* getIsolateCommandItems(void* page);
+void* getIsolateCommandStream(void* page);
+MERCURY_EXPORT_C
+int64_t getIsolateCommandStreamLength(void* page);
 MERCURY_EXPORT_C
 int64_t getIsolateCommandItemSize(void* page);
 MERCURY_EXPORT_C
+void* getIsolateCommandTelemetry(void* page);
+MERCURY_EXPORT_C
 void clearIsolateCommandItems(void* page);
+MERCURY_EXPORT_C
+void setIsolateCommandCoalescing(void* page, int8_t enabled);
+MERCURY_EXPORT_C
+int64_t getIsolateCommandElidedCount(void* page);
+MERCURY_EXPORT_C
+void resolveAsyncBindingCompletions(void* page, void* completions, int32_t count);
+MERCURY_EXPORT_C
+void dispatchEvents(void* page, void* dispatches, int32_t count, void* results);
+MERCURY_EXPORT_C
+void releaseNativeTypedArray(void* dart_isolate_context, int64_t id);
 
 MERCURY_EXPORT_C
 void init_dart_dynamic_linking(void* data);
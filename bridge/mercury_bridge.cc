@@ -8,7 +8,9 @@
 #include <thread>
 
 #include "bindings/qjs/native_string_utils.h"
+#include "core/binding_object.h"
 #include "core/dart_isolate_context.h"
+#include "core/event/event_target.h"
 #include "core/mercury_isolate.h"
 #include "foundation/isolate_command_buffer.h"
 #include "foundation/logging.h"
@@ -44,11 +46,14 @@ void* initDartIsolateContext(uint64_t* dart_methods, int32_t dart_methods_len) {
   return ptr;
 }
 
-void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercury_isolate_id) {
+void* allocateNewMercuryIsolate(void* dart_isolate_context, int32_t target_mercury_isolate_id, void* flush_policy) {
   assert(dart_isolate_context != nullptr);
-  auto mercury_isolate =
-      std::make_unique<mercury::MercuryIsolate>((mercury::DartIsolateContext*)dart_isolate_context,
-                                                        target_mercury_isolate_id, nullptr);
+  mercury::IsolateCommandFlushPolicy policy;
+  if (flush_policy != nullptr) {
+    policy = *reinterpret_cast<mercury::IsolateCommandFlushPolicy*>(flush_policy);
+  }
+  auto mercury_isolate = std::make_unique<mercury::MercuryIsolate>(
+      (mercury::DartIsolateContext*)dart_isolate_context, target_mercury_isolate_id, nullptr, policy);
   void* ptr = mercury_isolate.get();
   ((mercury::DartIsolateContext*)dart_isolate_context)->AddNewIsolate(std::move(mercury_isolate));
   return ptr;
@@ -110,10 +115,18 @@ MercuryInfo* getMercuryInfo() {
   return mercuryInfo;
 }
 
-void* getIsolateCommandItems(void* isolate_) {
+void* getIsolateCommandStream(void* isolate_) {
   auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
   assert(std::this_thread::get_id() == isolate->currentThread());
-  return isolate->GetExecutingContext()->isolateCommandBuffer()->data();
+  auto* isolate_command_buffer = isolate->GetExecutingContext()->isolateCommandBuffer();
+  isolate_command_buffer->PrepareFlush();
+  return (void*)isolate_command_buffer->stream();
+}
+
+int64_t getIsolateCommandStreamLength(void* isolate_) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  return isolate->GetExecutingContext()->isolateCommandBuffer()->streamLength();
 }
 
 int64_t getIsolateCommandItemSize(void* isolate_) {
@@ -122,12 +135,51 @@ int64_t getIsolateCommandItemSize(void* isolate_) {
   return isolate->GetExecutingContext()->isolateCommandBuffer()->size();
 }
 
+void* getIsolateCommandTelemetry(void* isolate_) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  return (void*)isolate->GetExecutingContext()->isolateCommandBuffer()->telemetry();
+}
+
 void clearIsolateCommandItems(void* isolate_) {
   auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
   assert(std::this_thread::get_id() == isolate->currentThread());
   isolate->GetExecutingContext()->isolateCommandBuffer()->clear();
 }
 
+void setIsolateCommandCoalescing(void* isolate_, int8_t enabled) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  isolate->GetExecutingContext()->isolateCommandBuffer()->SetCoalescingEnabled(enabled == 1);
+}
+
+int64_t getIsolateCommandElidedCount(void* isolate_) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  return isolate->GetExecutingContext()->isolateCommandBuffer()->elidedCommandCount();
+}
+
+void resolveAsyncBindingCompletions(void* isolate_, void* completions, int32_t count) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  mercury::BindingObject::HandleAnonymousAsyncCompletionsFromDart(
+      isolate->GetExecutingContext(), static_cast<mercury::NativeBindingAsyncCompletion*>(completions), count);
+}
+
+void dispatchEvents(void* isolate_, void* dispatches, int32_t count, void* results) {
+  auto isolate = reinterpret_cast<mercury::MercuryIsolate*>(isolate_);
+  assert(std::this_thread::get_id() == isolate->currentThread());
+  mercury::EventTarget::HandleDispatchEventsFromDart(isolate->GetExecutingContext(),
+                                                     static_cast<mercury::NativeEventDispatch*>(dispatches), count,
+                                                     static_cast<mercury::EventDispatchResult*>(results));
+}
+
+void releaseNativeTypedArray(void* dart_isolate_context_, int64_t id) {
+  auto* dart_isolate_context = (mercury::DartIsolateContext*)dart_isolate_context_;
+  assert(dart_isolate_context->valid());
+  dart_isolate_context->EnsureData()->nativeTypedArrays()->Release(id);
+}
+
 // Callbacks when dart context object was finalized by Dart GC.
 static void finalize_dart_context(void* isolate_callback_data, void* peer) {
   auto* dart_isolate_context = (mercury::DartIsolateContext*)peer;
@@ -529,13 +529,16 @@ function generateFunctionBody(blob: IDLBlob, declare: FunctionDeclaration, optio
   let returnValueResult = generateReturnValueResult(blob, declare.returnType, declare.returnTypeMode, options);
 
   let constructorPrototypeInit = (options.isConstructor && returnValueInit.length > 0) ? `
-  JSValue return_value_proto = JS_GetPrototype(ctx, return_value->ToQuickJSUnsafe());
-  JS_SetPrototype(ctx, proto, return_value_proto);
-  JS_SetPrototype(ctx, return_value->ToQuickJSUnsafe(), proto);
+  // Link a JS subclass in front of the prototype the wrapper was created with, unless it already inherits from it.
+  if (JS_IsInstanceOf(ctx, return_value->ToQuickJSUnsafe(), this_val) != 1) {
+    JSValue return_value_proto = JS_GetPrototype(ctx, return_value->ToQuickJSUnsafe());
+    JS_SetPrototype(ctx, proto, return_value_proto);
+    JS_SetPrototype(ctx, return_value->ToQuickJSUnsafe(), proto);
+    JS_FreeValue(ctx, return_value_proto);
+  }
   JS_FreeValue(ctx, proto);
   JS_FreeValue(ctx, constructor_fn);
   JS_FreeValue(ctx, fn_name_value);
-  JS_FreeValue(ctx, return_value_proto);
   ` : '';
 
   return `${paramCheck}
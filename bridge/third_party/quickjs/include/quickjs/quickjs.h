@@ -737,6 +737,7 @@ JS_BOOL JS_IsConstructor(JSContext* ctx, JSValueConst val);
 JS_BOOL JS_SetConstructorBit(JSContext *ctx, JSValueConst func_obj, JS_BOOL val);
 
 JSValue JS_NewArray(JSContext *ctx);
+JSValue JS_NewArrayFrom(JSContext *ctx, uint32_t len, JSValue *values);
 int JS_IsArray(JSContext *ctx, JSValueConst val);
 
 typedef struct InlineCache InlineCache;
@@ -1726,6 +1726,32 @@ JSValue JS_NewArray(JSContext* ctx) {
   return JS_NewObjectFromShape(ctx, js_dup_shape(ctx->array_shape), JS_CLASS_ARRAY);
 }
 
+/* Create a fast array of 'len' elements in one allocation. The values are
+   moved into the array and are freed in case of exception. */
+JSValue JS_NewArrayFrom(JSContext* ctx, uint32_t len, JSValue* values) {
+  JSValue obj;
+  JSObject* p;
+  uint32_t i;
+
+  obj = JS_NewArray(ctx);
+  if (JS_IsException(obj) || len > INT32_MAX)
+    goto fail;
+  if (len > 0) {
+    p = JS_VALUE_GET_OBJ(obj);
+    if (expand_fast_array(ctx, p, len))
+      goto fail;
+    memcpy(p->u.array.u.values, values, sizeof(JSValue) * len);
+    p->u.array.count = len;
+    p->prop[0].u.value = JS_NewInt32(ctx, len);
+  }
+  return obj;
+fail:
+  JS_FreeValue(ctx, obj);
+  for (i = 0; i < len; i++)
+    JS_FreeValue(ctx, values[i]);
+  return JS_EXCEPTION;
+}
+
 /* WARNING: proto must be an object or JS_NULL */
 JSValue JS_NewObjectProtoClass(JSContext* ctx, JSValueConst proto_val, JSClassID class_id) {
   JSShape* sh;
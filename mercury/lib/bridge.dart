@@ -10,3 +10,5 @@ export 'src/bridge/to_native.dart';
 export 'src/bridge/from_native.dart';
 export 'src/bridge/native_types.dart';
 export 'src/bridge/native_value.dart';
+export 'src/bridge/isolate_command_stream.dart';
+export 'src/bridge/structured_clone.dart';
@@ -5,6 +5,8 @@
 
 // Bind the JavaScript side object,
 // provide interface such as property setter/getter, call a property as function.
+import 'dart:async';
+import 'dart:collection';
 import 'dart:ffi';
 
 import 'package:ffi/ffi.dart';
@@ -46,46 +48,118 @@ void _dispatchCaptureEventToNative(Event event) {
   _dispatchEventToNative(event, true);
 }
 void _dispatchEventToNative(Event event, bool isCapture) {
-  Pointer<NativeBindingObject>? pointer = event.currentTarget?.pointer;
+  EventTarget? currentTarget = event.currentTarget;
+  Pointer<NativeBindingObject>? pointer = currentTarget?.pointer;
   int? contextId = event.target?.contextId;
   MercuryController controller = MercuryController.getControllerOfJSContextId(contextId)!;
   if (contextId != null && pointer != null && pointer.ref.invokeBindingMethodFromDart != nullptr) {
-    BindingObject bindingObject = controller.context.getBindingObject(pointer);
-    // Call methods implements at C++ side.
-    DartInvokeBindingMethodsFromDart f = pointer.ref.invokeBindingMethodFromDart.asFunction();
+    NativeEventListenerSummary? summary = BindingBridge.getListenerSummary(currentTarget!, event.type);
+    // All JS listeners of this type had been removed, the crossing would find nothing to call.
+    if (summary != null && summary.listenerCount == 0) return;
 
+    // Passive listeners are not able to cancel the event, and without bubbling the propagation state is not read
+    // after dispatch either, so there is no result to wait for.
+    if (summary != null && !summary.hasNonPassive && !event.bubbles) {
+      _pendingDispatches.add(_PendingDispatch(controller, pointer, event, isCapture));
+      if (!_pendingDispatchesScheduled) {
+        _pendingDispatchesScheduled = true;
+        scheduleMicrotask(drainPendingEventDispatches);
+      }
+      return;
+    }
+
+    drainPendingEventDispatches();
     Pointer<RawEvent> rawEvent = event.toRaw().cast<RawEvent>();
-    List<dynamic> dispatchEventArguments = [event.type, rawEvent, isCapture];
+    _invokeDispatchEvent(controller, pointer, event, rawEvent, isCapture, waitForResult: true);
+  }
+}
+
+class _PendingDispatch {
+  _PendingDispatch(this.controller, this.pointer, this.event, this.isCapture);
+
+  final MercuryController controller;
+  final Pointer<NativeBindingObject> pointer;
+  final Event event;
+  final bool isCapture;
+}
+
+// Dispatches which don't wait for their result, in the order they were dispatched.
+final Queue<_PendingDispatch> _pendingDispatches = Queue();
+bool _pendingDispatchesScheduled = false;
 
-    Stopwatch? stopwatch;
-    if (isEnabledLog) {
-      stopwatch = Stopwatch()..start();
+// Run the deferred dispatches before any dispatch which waits for its result, so JS listeners observe events in the
+// order they were dispatched. The raw event is built when the dispatch runs, after earlier dispatches of the same
+// event updated its sharedJSProps.
+void drainPendingEventDispatches() {
+  _pendingDispatchesScheduled = false;
+  while (_pendingDispatches.isNotEmpty) {
+    _PendingDispatch dispatch = _pendingDispatches.removeFirst();
+    Pointer<NativeBindingObject> pointer = dispatch.pointer;
+    if (!dispatch.controller.context.hasBindingObject(pointer) || pointer.ref.invokeBindingMethodFromDart == nullptr) {
+      continue;
     }
+    Pointer<RawEvent> rawEvent = dispatch.event.toRaw().cast<RawEvent>();
+    _invokeDispatchEvent(dispatch.controller, pointer, dispatch.event, rawEvent, dispatch.isCapture,
+        waitForResult: false);
+  }
+}
+
+void _invokeDispatchEvent(MercuryController controller, Pointer<NativeBindingObject> pointer, Event event,
+    Pointer<RawEvent> rawEvent, bool isCapture, {required bool waitForResult}) {
+  BindingObject bindingObject = controller.context.getBindingObject(pointer);
+  // Call methods implements at C++ side.
+  DartInvokeBindingMethodsFromDart f = pointer.ref.invokeBindingMethodFromDart.asFunction();
+
+  List<dynamic> dispatchEventArguments = [event.type, rawEvent, isCapture];
+
+  Stopwatch? stopwatch;
+  if (isEnabledLog) {
+    stopwatch = Stopwatch()..start();
+  }
 
-    Pointer<NativeValue> method = malloc.allocate(sizeOf<NativeValue>());
-    toNativeValue(method, 'dispatchEvent');
-    Pointer<NativeValue> allocatedNativeArguments = makeNativeValueArguments(bindingObject, dispatchEventArguments);
+  Pointer<NativeValue> method = malloc.allocate(sizeOf<NativeValue>());
+  toNativeValue(method, 'dispatchEvent');
+  Pointer<NativeValue> allocatedNativeArguments = makeNativeValueArguments(bindingObject, dispatchEventArguments);
 
-    Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
-    f(pointer, returnValue, method, dispatchEventArguments.length, allocatedNativeArguments, event);
-    Pointer<EventDispatchResult> dispatchResult = fromNativeValue(controller.context, returnValue).cast<EventDispatchResult>();
+  Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
+  f(pointer, returnValue, method, dispatchEventArguments.length, allocatedNativeArguments, event);
+  Pointer<EventDispatchResult> dispatchResult = fromNativeValue(controller.context, returnValue).cast<EventDispatchResult>();
+  if (waitForResult) {
     event.cancelable = dispatchResult.ref.canceled;
     event.propagationStopped = dispatchResult.ref.propagationStopped;
+  }
 
-    event.sharedJSProps = Pointer.fromAddress(rawEvent.ref.bytes.elementAt(8).value);
-    event.propLen = rawEvent.ref.bytes.elementAt(9).value;
-    event.allocateLen = rawEvent.ref.bytes.elementAt(10).value;
+  event.sharedJSProps = Pointer.fromAddress(rawEvent.ref.bytes.elementAt(8).value);
+  event.propLen = rawEvent.ref.bytes.elementAt(9).value;
+  event.allocateLen = rawEvent.ref.bytes.elementAt(10).value;
 
-    if (isEnabledLog) {
-      print('dispatch event to native side: target: ${event.target} arguments: $dispatchEventArguments time: ${stopwatch!.elapsedMicroseconds}us');
-    }
+  if (isEnabledLog) {
+    print('dispatch event to native side: target: ${event.target} arguments: $dispatchEventArguments time: ${stopwatch!.elapsedMicroseconds}us');
+  }
+
+  // Free the allocated arguments.
+  malloc.free(rawEvent);
+  malloc.free(method);
+  malloc.free(allocatedNativeArguments);
+  malloc.free(dispatchResult);
+  malloc.free(returnValue);
+}
+
+// Summary of the JS listeners of one event type on a target, kept up to date by the native side through
+// updateEventListenerSummary commands. Unpacked from |listenerCount << 2 | hasCapture << 1 | hasNonPassive|.
+class NativeEventListenerSummary {
+  final int listenerCount;
+  final bool hasNonPassive;
+  final bool hasCapture;
 
-    // Free the allocated arguments.
-    malloc.free(rawEvent);
-    malloc.free(method);
-    malloc.free(allocatedNativeArguments);
-    malloc.free(dispatchResult);
-    malloc.free(returnValue);
+  NativeEventListenerSummary.fromPacked(int packed)
+      : listenerCount = packed >> 2,
+        hasCapture = (packed & 2) != 0,
+        hasNonPassive = (packed & 1) != 0;
+
+  @override
+  String toString() {
+    return 'NativeEventListenerSummary(listenerCount: $listenerCount, hasNonPassive: $hasNonPassive, hasCapture: $hasCapture)';
   }
 }
 
@@ -177,6 +251,19 @@ abstract class BindingBridge {
 
   }
 
+  static final Expando<Map<String, NativeEventListenerSummary>> _listenerSummaries = Expando();
+
+  static void updateListenerSummary(EventTarget target, String type, NativeEventListenerSummary summary) {
+    // Summaries without listeners are kept, so dispatches of the type can be skipped.
+    Map<String, NativeEventListenerSummary> summaries = _listenerSummaries[target] ??= {};
+    summaries[type] = summary;
+  }
+
+  // Return null if the native side has not reported any listener of the type yet.
+  static NativeEventListenerSummary? getListenerSummary(EventTarget target, String type) {
+    return _listenerSummaries[target]?[type];
+  }
+
   static bool hasListener(EventTarget target, String type, {bool isCapture = false}) {
     Map<String, List<EventHandler>> eventHandlers = isCapture ? target.getCaptureEventHandlers() : target.getEventHandlers();
     List<EventHandler>? handlers = eventHandlers[type];
@@ -26,7 +26,7 @@ int initBridge(MercuryContextController view) {
   BindingBridge.setup();
 
   int mercuryIsolateId = newMercuryIsolateId();
-  allocateNewMercuryIsolate(mercuryIsolateId);
+  allocateNewMercuryIsolate(mercuryIsolateId, flushPolicy: view.rootController.isolateCommandFlushPolicy);
 
   return mercuryIsolateId;
 }
@@ -145,11 +145,10 @@ Pointer<NativeValue> _invokeModule(
     Pointer<NativeFunction<NativeAsyncModuleCallback>> callback) {
   MercuryController controller = MercuryController.getControllerOfJSContextId(contextId)!;
   dynamic result = invokeModule(callbackContext, controller, nativeStringToString(module), nativeStringToString(method),
-      fromNativeValue(controller.context, params), callback.asFunction());
+      fromNativeValue(controller.context, params, borrowed: true), callback.asFunction());
   Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
   toNativeValue(returnValue, result);
-  freeNativeString(module);
-  freeNativeString(method);
+  // Module and method names are borrowed from the string cache of the bridge.
   return returnValue;
 }
 
@@ -266,6 +265,17 @@ void _flushIsolateCommand(int contextId) {
 
 final Pointer<NativeFunction<NativeFlushIsolateCommand>> _nativeFlushIsolateCommand = Pointer.fromFunction(_flushIsolateCommand);
 
+typedef NativeRequestBatchUpdate = Void Function(Int32 contextId);
+
+// Flush the isolate commands once after the current task, commands added before that are sent in one batch.
+void _requestBatchUpdate(int contextId) {
+  scheduleMicrotask(() {
+    flushIsolateCommandWithContextId(contextId);
+  });
+}
+
+final Pointer<NativeFunction<NativeRequestBatchUpdate>> _nativeRequestBatchUpdate = Pointer.fromFunction(_requestBatchUpdate);
+
 typedef NativeCreateBindingObject = Void Function(Int32 contextId, Pointer<NativeBindingObject> nativeBindingObject, Int32 type, Pointer<NativeValue> args, Int32 argc);
 typedef DartCreateBindingObject = void Function(int contextId, Pointer<NativeBindingObject> nativeBindingObject, int type, Pointer<NativeValue> args, int argc);
 
@@ -313,6 +323,7 @@ final List<int> _dartNativeMethods = [
   _nativeCreateBindingObject.address,
   _nativeOnJsError.address,
   _nativeOnJsLog.address,
+  _nativeRequestBatchUpdate.address,
 ];
 
 List<int> makeDartMethodsData() {
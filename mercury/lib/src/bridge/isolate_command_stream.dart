@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'from_native.dart';
+import 'to_native.dart';
+
+// Must be the same as ISOLATE_COMMAND_STREAM_VERSION in bridge/foundation/isolate_command_stream.h
+const int isolateCommandStreamVersion = 3;
+
+enum IsolateCommandStringKind {
+  inlineLatin1,
+  inlineUTF16,
+  pointer,
+}
+
+// Decoder of the variable-length isolate commands stream written by IsolateCommandStreamWriter.
+//
+//   stream  := version:uleb count:uleb command*
+//   command := opcode:uleb operands
+//   pointer := sleb (delta against the previous pointer of the same operand)
+//   string  := header:uleb (length << 2 | kind) payload
+class IsolateCommandStreamReader {
+  IsolateCommandStreamReader(Pointer<Uint8> stream, int length) : _bytes = stream.asTypedList(length);
+
+  final Uint8List _bytes;
+  int _offset = 0;
+
+  int _previousPtr = 0;
+  int _previousOptions = 0;
+  int _previousString = 0;
+
+  int _readVarUint() {
+    int result = 0;
+    int shift = 0;
+    int byte;
+    do {
+      byte = _bytes[_offset++];
+      result |= (byte & 0x7f) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    return result;
+  }
+
+  int _readVarInt() {
+    int result = 0;
+    int shift = 0;
+    int byte;
+    do {
+      byte = _bytes[_offset++];
+      result |= (byte & 0x7f) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    if (shift < 64 && (byte & 0x40) != 0) {
+      result |= -1 << shift;
+    }
+    return result;
+  }
+
+  int _readPointer(int previous) {
+    return previous + _readVarInt();
+  }
+
+  String _readString() {
+    int header = _readVarUint();
+    int length = header >> 2;
+    IsolateCommandStringKind kind = IsolateCommandStringKind.values[header & 0x03];
+    switch (kind) {
+      case IsolateCommandStringKind.inlineLatin1:
+        String result = String.fromCharCodes(_bytes, _offset, _offset + length);
+        _offset += length;
+        return result;
+      case IsolateCommandStringKind.inlineUTF16:
+        List<int> codeUnits = List.generate(length, (int i) {
+          int index = _offset + i * 2;
+          return _bytes[index] | (_bytes[index + 1] << 8);
+        }, growable: false);
+        _offset += length * 2;
+        return String.fromCharCodes(codeUnits);
+      case IsolateCommandStringKind.pointer:
+        _previousString = _readPointer(_previousString);
+        return uint16ToString(Pointer.fromAddress(_previousString), length);
+      default:
+        throw UnsupportedError('Unsupported isolate command string kind: $kind');
+    }
+  }
+
+  List<IsolateCommand> readCommands() {
+    int version = _readVarUint();
+    if (version != isolateCommandStreamVersion) {
+      throw UnsupportedError('Unsupported isolate command stream version: $version');
+    }
+
+    int commandLength = _readVarUint();
+    return List.generate(commandLength, (int _) {
+      IsolateCommand command = IsolateCommand();
+      IsolateCommandType type = IsolateCommandType.values[_readVarUint()];
+      _previousPtr = _readPointer(_previousPtr);
+
+      String args = '';
+      Pointer nativePtr2 = nullptr;
+      switch (type) {
+        case IsolateCommandType.createGlobal:
+        case IsolateCommandType.createEventTarget:
+          args = _readString();
+          break;
+        case IsolateCommandType.addEvent:
+          args = _readString();
+          _previousOptions = _readPointer(_previousOptions);
+          nativePtr2 = _previousOptions != 0 ? Pointer.fromAddress(_previousOptions) : nullptr;
+          break;
+        case IsolateCommandType.removeEvent:
+          args = _readString();
+          // Keep the same representation of the capture flag as the native side.
+          nativePtr2 = _readVarUint() == 1 ? Pointer.fromAddress(1) : nullptr;
+          break;
+        case IsolateCommandType.updateEventListenerSummary:
+          args = _readString();
+          // The packed summary, see NativeEventListenerSummary.
+          nativePtr2 = Pointer.fromAddress(_readVarUint());
+          break;
+        default:
+          break;
+      }
+
+      command.type = type;
+      command.args = args;
+      command.nativePtr = _previousPtr != 0 ? Pointer.fromAddress(_previousPtr) : nullptr;
+      command.nativePtr2 = nativePtr2;
+      return command;
+    }, growable: false);
+  }
+}
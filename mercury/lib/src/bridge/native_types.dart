@@ -20,6 +20,71 @@ class NativeMercuryInfo extends Struct {
   external Pointer<Utf8> system_name;
 }
 
+class NativeIsolateCommandFlushPolicy extends Struct {
+  @Int32()
+  external int mode;
+
+  @Int32()
+  external int max_pending_items;
+
+  @Int64()
+  external int max_pending_bytes;
+}
+
+// Must be the same as ISOLATE_COMMAND_TYPE_COUNT and ISOLATE_COMMAND_LATENCY_BUCKET_COUNT in
+// bridge/foundation/isolate_command_buffer.h
+const int isolateCommandTypeCount = 6;
+const int isolateCommandLatencyBucketCount = 8;
+
+class NativeIsolateCommandTelemetry extends Struct {
+  @Array(isolateCommandTypeCount)
+  external Array<Int64> command_counts;
+
+  @Int64()
+  external int flush_count;
+
+  @Int64()
+  external int total_bytes;
+
+  @Int64()
+  external int last_flush_bytes;
+
+  @Int64()
+  external int max_flush_bytes;
+
+  @Int64()
+  external int max_buffer_size;
+
+  @Double()
+  external double flushes_per_second;
+
+  @Array(isolateCommandLatencyBucketCount)
+  external Array<Int64> latency_histogram;
+}
+
+// Only the leading fields of the C++ struct are visible to dart, the struct is always allocated by the native side.
+class NativeTypedArray extends Struct {
+  external Pointer<Uint8> bytes;
+
+  @Int64()
+  external int byteLength;
+
+  @Int32()
+  external int type;
+
+  @Int64()
+  external int id;
+}
+
+// One settled async binding call, handed over to the native side in batches.
+class NativeBindingAsyncCompletion extends Struct {
+  external Pointer<Void> promiseContext;
+
+  external Pointer<NativeValue> value;
+
+  external Pointer<Utf8> errmsg;
+}
+
 // An native struct can be directly convert to javaScript String without any conversion cost.
 class NativeString extends Struct {
   external Pointer<Uint16> string;
@@ -49,6 +114,21 @@ class EventDispatchResult extends Struct {
   external bool propagationStopped;
 }
 
+// One event of a batch dispatched to the native side, see dispatchEventsToNative().
+class NativeEventDispatch extends Struct {
+  external Pointer<NativeBindingObject> target;
+
+  external Pointer<NativeString> type;
+
+  external Pointer<RawEvent> rawEvent;
+
+  @Int8()
+  external int isCapture;
+
+  @Int8()
+  external int recycle;
+}
+
 class AddEventListenerOptions extends Struct {
   @Bool()
   external bool capture;
@@ -124,11 +204,15 @@ class NativeBindingObject extends Struct {
   external Pointer<NativeFunction<InvokeBindingMethodsFromDart>> invokeBindingMethodFromDart;
   // Shared method called by JS side.
   external Pointer<NativeFunction<InvokeBindingsMethodsFromNative>> invokeBindingMethodFromNative;
+  // Only used by the native side to track commands referencing this object.
+  @Int64()
+  external int pendingCommandEpoch;
 }
 
 Pointer<NativeBindingObject> allocateNewBindingObject() {
   Pointer<NativeBindingObject> pointer = malloc.allocate(sizeOf<NativeBindingObject>());
   pointer.ref.disposed = false;
+  pointer.ref.pendingCommandEpoch = 0;
   return pointer;
 }
 
@@ -33,7 +33,60 @@ enum JSValueType {
   TAG_POINTER,
   TAG_FUNCTION,
   TAG_ASYNC_FUNCTION,
-  TAG_UINT8_BYTES
+  TAG_UINT8_BYTES,
+  TAG_TYPED_ARRAY,
+  TAG_STRUCTURED_CLONE,
+  TAG_FLOAT64_LIST,
+  TAG_INT32_LIST,
+  TAG_INT64_LIST,
+  TAG_BOOL_LIST,
+  TAG_LATIN1_STRING
+}
+
+enum NativeTypedArrayType {
+  ArrayBuffer,
+  Int8,
+  Uint8,
+  Uint8Clamped,
+  Int16,
+  Uint16,
+  Int32,
+  Uint32,
+  Float32,
+  Float64
+}
+
+// Views of JS buffers are backed by the JS memory directly, the native side keeps the bytes alive until the view has
+// been garbage collected, even when the context is disposed first. The finalizer releases the record by its id.
+final Finalizer<int> _typedArrayFinalizer = Finalizer((id) => releaseNativeTypedArray(id));
+
+TypedData _fromNativeTypedArray(Pointer<NativeTypedArray> typedArray) {
+  int byteLength = typedArray.ref.byteLength;
+  Uint8List bytes = typedArray.ref.bytes.asTypedList(byteLength);
+  // Other views share the external bytes, which are kept reachable by the views.
+  _typedArrayFinalizer.attach(bytes, typedArray.ref.id);
+
+  switch (NativeTypedArrayType.values[typedArray.ref.type]) {
+    case NativeTypedArrayType.ArrayBuffer:
+    case NativeTypedArrayType.Uint8:
+      return bytes;
+    case NativeTypedArrayType.Int8:
+      return bytes.buffer.asInt8List(0, byteLength);
+    case NativeTypedArrayType.Uint8Clamped:
+      return bytes.buffer.asUint8ClampedList(0, byteLength);
+    case NativeTypedArrayType.Int16:
+      return bytes.buffer.asInt16List(0, byteLength ~/ 2);
+    case NativeTypedArrayType.Uint16:
+      return bytes.buffer.asUint16List(0, byteLength ~/ 2);
+    case NativeTypedArrayType.Int32:
+      return bytes.buffer.asInt32List(0, byteLength ~/ 4);
+    case NativeTypedArrayType.Uint32:
+      return bytes.buffer.asUint32List(0, byteLength ~/ 4);
+    case NativeTypedArrayType.Float32:
+      return bytes.buffer.asFloat32List(0, byteLength ~/ 4);
+    case NativeTypedArrayType.Float64:
+      return bytes.buffer.asFloat64List(0, byteLength ~/ 8);
+  }
 }
 
 enum JSPointerType {
@@ -44,7 +97,9 @@ enum JSPointerType {
 typedef AnonymousNativeFunction = dynamic Function(List<dynamic> args);
 typedef AsyncAnonymousNativeFunction = Future<dynamic> Function(List<dynamic> args);
 
-dynamic fromNativeValue(MercuryContextController view, Pointer<NativeValue> nativeValue) {
+// Values allocated in a NativeValueArena are [borrowed]: they are released by the C++ side after the call returns,
+// so the strings, lists and payloads must not be freed here.
+dynamic fromNativeValue(MercuryContextController view, Pointer<NativeValue> nativeValue, {bool borrowed = false}) {
   if (nativeValue == nullptr) return null;
 
   JSValueType type = JSValueType.values[nativeValue.ref.tag];
@@ -52,8 +107,12 @@ dynamic fromNativeValue(MercuryContextController view, Pointer<NativeValue> nati
     case JSValueType.TAG_STRING:
       Pointer<NativeString> nativeString = Pointer.fromAddress(nativeValue.ref.u);
       String result = nativeStringToString(nativeString);
-      freeNativeString(nativeString);
+      if (!borrowed) freeNativeString(nativeString);
       return result;
+    case JSValueType.TAG_LATIN1_STRING:
+      // Borrowed from a JS string, copy the characters without freeing them.
+      Pointer<Uint8> characters = Pointer.fromAddress(nativeValue.ref.u);
+      return String.fromCharCodes(characters.asTypedList(nativeValue.ref.uint32));
     case JSValueType.TAG_INT:
       return nativeValue.ref.u;
     case JSValueType.TAG_BOOL:
@@ -72,9 +131,9 @@ dynamic fromNativeValue(MercuryContextController view, Pointer<NativeValue> nati
     case JSValueType.TAG_LIST:
       Pointer<NativeValue> head = Pointer.fromAddress(nativeValue.ref.u).cast<NativeValue>();
       List result = List.generate(nativeValue.ref.uint32, (index) {
-        return fromNativeValue(view, head.elementAt(index));
+        return fromNativeValue(view, head.elementAt(index), borrowed: borrowed);
       });
-      malloc.free(head);
+      if (!borrowed) malloc.free(head);
       return result;
     case JSValueType.TAG_FUNCTION:
     case JSValueType.TAG_ASYNC_FUNCTION:
@@ -87,6 +146,33 @@ dynamic fromNativeValue(MercuryContextController view, Pointer<NativeValue> nati
     case JSValueType.TAG_UINT8_BYTES:
       Pointer<Uint8> buffer = Pointer.fromAddress(nativeValue.ref.u);
       return buffer.asTypedList(nativeValue.ref.uint32);
+    case JSValueType.TAG_TYPED_ARRAY:
+      return _fromNativeTypedArray(Pointer.fromAddress(nativeValue.ref.u));
+    case JSValueType.TAG_STRUCTURED_CLONE:
+      Pointer<Uint8> bytes = Pointer.fromAddress(nativeValue.ref.u);
+      dynamic value = StructuredCloneReader(bytes, nativeValue.ref.uint32).read();
+      if (!borrowed) malloc.free(bytes);
+      return value;
+    case JSValueType.TAG_FLOAT64_LIST:
+      Pointer<Double> elements = Pointer.fromAddress(nativeValue.ref.u);
+      List<double> result = List.of(elements.asTypedList(nativeValue.ref.uint32));
+      malloc.free(elements);
+      return result;
+    case JSValueType.TAG_INT32_LIST:
+      Pointer<Int32> elements = Pointer.fromAddress(nativeValue.ref.u);
+      List<int> result = List.of(elements.asTypedList(nativeValue.ref.uint32));
+      malloc.free(elements);
+      return result;
+    case JSValueType.TAG_INT64_LIST:
+      Pointer<Int64> elements = Pointer.fromAddress(nativeValue.ref.u);
+      List<int> result = List.of(elements.asTypedList(nativeValue.ref.uint32));
+      malloc.free(elements);
+      return result;
+    case JSValueType.TAG_BOOL_LIST:
+      Pointer<Uint8> elements = Pointer.fromAddress(nativeValue.ref.u);
+      List<bool> result = elements.asTypedList(nativeValue.ref.uint32).map((value) => value != 0).toList();
+      malloc.free(elements);
+      return result;
   }
 }
 
@@ -117,6 +203,23 @@ void toNativeValue(Pointer<NativeValue> target, value, [BindingObject? ownerBind
     target.ref.tag = JSValueType.TAG_UINT8_BYTES.index;
     target.ref.uint32 = value.length;
     target.ref.u = buffer.address;
+  } else if (value is List<double>) {
+    Pointer<Double> elements = malloc.allocate(sizeOf<Double>() * value.length);
+    elements.asTypedList(value.length).setAll(0, value);
+    target.ref.tag = JSValueType.TAG_FLOAT64_LIST.index;
+    target.ref.uint32 = value.length;
+    target.ref.u = elements.address;
+  } else if (value is List<int>) {
+    _toNativeIntList(target, value);
+  } else if (value is List<bool>) {
+    Pointer<Uint8> elements = malloc.allocate(sizeOf<Uint8>() * value.length);
+    Uint8List bytes = elements.asTypedList(value.length);
+    for (int i = 0; i < value.length; i++) {
+      bytes[i] = value[i] ? 1 : 0;
+    }
+    target.ref.tag = JSValueType.TAG_BOOL_LIST.index;
+    target.ref.uint32 = value.length;
+    target.ref.u = elements.address;
   } else if (value is BindingObject) {
     assert((value.pointer)!.address != nullptr);
     target.ref.tag = JSValueType.TAG_POINTER.index;
@@ -130,6 +233,13 @@ void toNativeValue(Pointer<NativeValue> target, value, [BindingObject? ownerBind
     for(int i = 0; i < value.length; i ++) {
       toNativeValue(lists.elementAt(i), value[i], ownerBindingObject);
     }
+  } else if (value is Map) {
+    Uint8List bytes = StructuredCloneWriter().write(value);
+    Pointer<Uint8> buffer = malloc.allocate(bytes.length);
+    buffer.asTypedList(bytes.length).setAll(0, bytes);
+    target.ref.tag = JSValueType.TAG_STRUCTURED_CLONE.index;
+    target.ref.uint32 = bytes.length;
+    target.ref.u = buffer.address;
   } else if (value is Object) {
     String str = jsonEncode(value);
     target.ref.tag = JSValueType.TAG_JSON.index;
@@ -137,6 +247,27 @@ void toNativeValue(Pointer<NativeValue> target, value, [BindingObject? ownerBind
   }
 }
 
+const int _minInt32 = -0x80000000;
+const int _maxInt32 = 0x7fffffff;
+
+// Pack ints as int32 when all of them fit, which become SMIs at the JS side.
+void _toNativeIntList(Pointer<NativeValue> target, List<int> value) {
+  bool isInt32 = value is Int32List || value is Int16List || value is Int8List || value is Uint16List ||
+      value.every((element) => element >= _minInt32 && element <= _maxInt32);
+  if (isInt32) {
+    Pointer<Int32> elements = malloc.allocate(sizeOf<Int32>() * value.length);
+    elements.asTypedList(value.length).setAll(0, value);
+    target.ref.tag = JSValueType.TAG_INT32_LIST.index;
+    target.ref.u = elements.address;
+  } else {
+    Pointer<Int64> elements = malloc.allocate(sizeOf<Int64>() * value.length);
+    elements.asTypedList(value.length).setAll(0, value);
+    target.ref.tag = JSValueType.TAG_INT64_LIST.index;
+    target.ref.u = elements.address;
+  }
+  target.ref.uint32 = value.length;
+}
+
 Pointer<NativeValue> makeNativeValueArguments(BindingObject ownerBindingObject, List<dynamic> args) {
   Pointer<NativeValue> buffer = malloc.allocate(sizeOf<NativeValue>() * args.length);
 
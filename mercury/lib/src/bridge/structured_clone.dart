@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2022-present The WebF authors. All rights reserved.
+ */
+
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+// Must be the same as STRUCTURED_CLONE_VERSION in bridge/bindings/qjs/structured_clone.h
+const int structuredCloneVersion = 1;
+const int _maxDepth = 256;
+
+const int _tagNull = 0;
+const int _tagFalse = 1;
+const int _tagTrue = 2;
+const int _tagInt = 3;
+const int _tagDouble = 4;
+const int _tagString = 5;
+const int _tagArray = 6;
+const int _tagObject = 7;
+const int _tagBackReference = 8;
+
+// Encoder of the structured clone format read by StructuredCloneReader, see bridge/bindings/qjs/structured_clone.h
+// for the layout. Objects which are neither Map nor List are converted by their toJson() first.
+class StructuredCloneWriter {
+  final BytesBuilder _bytes = BytesBuilder(copy: false);
+  final Map<Object, int> _objects = Map.identity();
+  final Map<String, int> _keys = {};
+  final ByteData _scratch = ByteData(8);
+
+  Uint8List write(Object? value) {
+    _writeVarUint(structuredCloneVersion);
+    _writeValue(value, 0);
+    return _bytes.takeBytes();
+  }
+
+  void _writeValue(Object? value, int depth) {
+    if (value == null) {
+      _bytes.addByte(_tagNull);
+    } else if (value is bool) {
+      _bytes.addByte(value ? _tagTrue : _tagFalse);
+    } else if (value is int) {
+      _bytes.addByte(_tagInt);
+      _writeVarInt(value);
+    } else if (value is double) {
+      _bytes.addByte(_tagDouble);
+      _scratch.setFloat64(0, value, Endian.little);
+      _bytes.add(_scratch.buffer.asUint8List(0, 8));
+    } else if (value is String) {
+      _bytes.addByte(_tagString);
+      _writeCharacters(value);
+    } else if (value is List || value is Map) {
+      if (depth >= _maxDepth) throw StateError('Maximum structured clone depth exceeded');
+      int? index = _objects[value];
+      if (index != null) {
+        _bytes.addByte(_tagBackReference);
+        _writeVarUint(index);
+        return;
+      }
+      _objects[value] = _objects.length;
+      if (value is List) {
+        _writeList(value, depth + 1);
+      } else {
+        _writeMap(value as Map, depth + 1);
+      }
+    } else {
+      _writeValue(jsonDecode(jsonEncode(value)), depth);
+    }
+  }
+
+  void _writeList(List list, int depth) {
+    _bytes.addByte(_tagArray);
+    _writeVarUint(list.length);
+    for (Object? element in list) {
+      _writeValue(element, depth);
+    }
+  }
+
+  void _writeMap(Map map, int depth) {
+    _bytes.addByte(_tagObject);
+    map.forEach((key, value) {
+      _writeKey(key.toString());
+      _writeValue(value, depth);
+    });
+    _writeVarUint(0);
+  }
+
+  void _writeKey(String key) {
+    int? index = _keys[key];
+    if (index != null) {
+      _writeVarUint(index + 2);
+      return;
+    }
+    _keys[key] = _keys.length;
+    _writeVarUint(1);
+    _writeCharacters(key);
+  }
+
+  void _writeCharacters(String string) {
+    List<int> codeUnits = string.codeUnits;
+    bool isUTF16 = codeUnits.any((unit) => unit > 0xff);
+    _writeVarUint(codeUnits.length << 1 | (isUTF16 ? 1 : 0));
+    if (!isUTF16) {
+      _bytes.add(codeUnits);
+      return;
+    }
+    ByteData data = ByteData(codeUnits.length * 2);
+    for (int i = 0; i < codeUnits.length; i++) {
+      data.setUint16(i * 2, codeUnits[i], Endian.little);
+    }
+    _bytes.add(data.buffer.asUint8List());
+  }
+
+  void _writeVarUint(int value) {
+    do {
+      int byte = value & 0x7f;
+      value >>= 7;
+      if (value != 0) byte |= 0x80;
+      _bytes.addByte(byte);
+    } while (value != 0);
+  }
+
+  void _writeVarInt(int value) {
+    bool more = true;
+    while (more) {
+      int byte = value & 0x7f;
+      value >>= 7;
+      if ((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0)) {
+        more = false;
+      } else {
+        byte |= 0x80;
+      }
+      _bytes.addByte(byte);
+    }
+  }
+}
+
+// Decoder of the bytes written by StructuredCloneWriter at the C++ side.
+class StructuredCloneReader {
+  StructuredCloneReader(Pointer<Uint8> bytes, int length) : _bytes = bytes.asTypedList(length);
+
+  final Uint8List _bytes;
+  int _offset = 0;
+  final List<Object> _objects = [];
+  final List<String> _keys = [];
+
+  dynamic read() {
+    int version = _readVarUint();
+    if (version != structuredCloneVersion) {
+      throw FormatException('Unsupported structured clone version $version');
+    }
+    return _readValue(0);
+  }
+
+  dynamic _readValue(int depth) {
+    if (depth >= _maxDepth) throw FormatException('Malformed structured clone data');
+    int tag = _readByte();
+    switch (tag) {
+      case _tagNull:
+        return null;
+      case _tagFalse:
+        return false;
+      case _tagTrue:
+        return true;
+      case _tagInt:
+        return _readVarInt();
+      case _tagDouble:
+        _checkRemaining(8);
+        double value = ByteData.sublistView(_bytes, _offset, _offset + 8).getFloat64(0, Endian.little);
+        _offset += 8;
+        return value;
+      case _tagString:
+        return _readCharacters();
+      case _tagArray:
+        int length = _readVarUint();
+        // Every element takes at least one byte.
+        _checkRemaining(length);
+        List list = List.filled(length, null, growable: true);
+        _objects.add(list);
+        for (int i = 0; i < length; i++) {
+          list[i] = _readValue(depth + 1);
+        }
+        return list;
+      case _tagObject:
+        Map<String, dynamic> map = {};
+        _objects.add(map);
+        while (true) {
+          int index = _readVarUint();
+          if (index == 0) break;
+          String key;
+          if (index == 1) {
+            key = _readCharacters();
+            _keys.add(key);
+          } else {
+            if (index - 2 >= _keys.length) throw FormatException('Malformed structured clone data');
+            key = _keys[index - 2];
+          }
+          map[key] = _readValue(depth + 1);
+        }
+        return map;
+      case _tagBackReference:
+        int index = _readVarUint();
+        if (index >= _objects.length) throw FormatException('Malformed structured clone data');
+        return _objects[index];
+    }
+    throw FormatException('Malformed structured clone data');
+  }
+
+  String _readCharacters() {
+    int header = _readVarUint();
+    int length = header >> 1;
+    if (header & 1 == 0) {
+      _checkRemaining(length);
+      String value = String.fromCharCodes(_bytes, _offset, _offset + length);
+      _offset += length;
+      return value;
+    }
+    _checkRemaining(length * 2);
+    ByteData data = ByteData.sublistView(_bytes, _offset, _offset + length * 2);
+    List<int> codeUnits = List.generate(length, (i) => data.getUint16(i * 2, Endian.little));
+    _offset += length * 2;
+    return String.fromCharCodes(codeUnits);
+  }
+
+  void _checkRemaining(int length) {
+    if (length < 0 || length > _bytes.length - _offset) throw FormatException('Malformed structured clone data');
+  }
+
+  int _readByte() {
+    _checkRemaining(1);
+    return _bytes[_offset++];
+  }
+
+  int _readVarUint() {
+    int result = 0;
+    int shift = 0;
+    int byte;
+    do {
+      if (shift >= 64) throw FormatException('Malformed structured clone data');
+      byte = _readByte();
+      result |= (byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80 != 0);
+    return result;
+  }
+
+  int _readVarInt() {
+    int result = 0;
+    int shift = 0;
+    int byte;
+    do {
+      if (shift >= 64) throw FormatException('Malformed structured clone data');
+      byte = _readByte();
+      result |= (byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80 != 0);
+    if (shift < 64 && (byte & 0x40) != 0) result |= -1 << shift;
+    return result;
+  }
+}
@@ -3,6 +3,7 @@
  * Copyright (C) 2022-present The WebF authors. All rights reserved.
  */
 
+import 'dart:async';
 import 'dart:collection';
 import 'dart:ffi';
 import 'dart:io';
@@ -13,6 +14,8 @@ import 'package:flutter/foundation.dart';
 import 'package:mercuryjs/src/global/event.dart';
 import 'package:mercuryjs/mercuryjs.dart';
 
+import 'isolate_command_stream.dart';
+
 // Steps for using dart:ffi to call a C function from Dart:
 // 1. Import dart:ffi.
 // 2. Create a typedef with the FFI type signature of the C function.
@@ -153,6 +156,7 @@ Future<bool> evaluateScripts(int contextId, String code, {String? url, int line
 
     return result;
   } else {
+    // The native side transcodes the source to UTF-8 in place, so the buffer must not be read after the call.
     Pointer<NativeString> nativeString = stringToNativeString(code);
     Pointer<Utf8> _url = url.toNativeUtf8();
     try {
@@ -172,9 +176,10 @@ Future<bool> evaluateScripts(int contextId, String code, {String? url, int line
       return result == 1;
     } catch (e, stack) {
       print('$e\n$stack');
+    } finally {
+      freeNativeString(nativeString);
+      malloc.free(_url);
     }
-    freeNativeString(nativeString);
-    malloc.free(_url);
   }
   return false;
 }
@@ -247,14 +252,43 @@ int newMercuryIsolateId() {
   return _newMercuryIsolateId();
 }
 
-typedef NativeAllocateNewMercuryIsolate = Pointer<Void> Function(Pointer<Void>, Int32);
-typedef DartAllocateNewMercuryIsolate = Pointer<Void> Function(Pointer<Void>, int);
+typedef NativeAllocateNewMercuryIsolate = Pointer<Void> Function(Pointer<Void>, Int32, Pointer<NativeIsolateCommandFlushPolicy>);
+typedef DartAllocateNewMercuryIsolate = Pointer<Void> Function(Pointer<Void>, int, Pointer<NativeIsolateCommandFlushPolicy>);
 
 final DartAllocateNewMercuryIsolate _allocateNewMercuryIsolate =
     MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeAllocateNewMercuryIsolate>>('allocateNewMercuryIsolate').asFunction();
 
-void allocateNewMercuryIsolate(int targetContextId) {
-  Pointer<Void> mercuryIsolate = _allocateNewMercuryIsolate(dartContext.pointer, targetContextId);
+// Must be the same order as IsolateCommandFlushMode in bridge/foundation/isolate_command_buffer.h
+enum IsolateCommandFlushMode {
+  // Flush once after the current task, on the first isolate command after every flush.
+  batchUpdate,
+  // Same as batchUpdate, and flush immediately once the pending commands exceed the thresholds.
+  threshold,
+  // Never schedule flushes while the scripts are running, schedule one after the outermost script turn finished.
+  afterScriptTurn,
+}
+
+class IsolateCommandFlushPolicy {
+  const IsolateCommandFlushPolicy({this.mode = IsolateCommandFlushMode.batchUpdate, this.maxPendingItems = 0, this.maxPendingBytes = 0});
+
+  final IsolateCommandFlushMode mode;
+  // Thresholds for the threshold mode, zero means no limit.
+  final int maxPendingItems;
+  final int maxPendingBytes;
+}
+
+void allocateNewMercuryIsolate(int targetContextId, {IsolateCommandFlushPolicy? flushPolicy}) {
+  Pointer<NativeIsolateCommandFlushPolicy> nativeFlushPolicy = nullptr;
+  if (flushPolicy != null) {
+    nativeFlushPolicy = malloc.allocate<NativeIsolateCommandFlushPolicy>(sizeOf<NativeIsolateCommandFlushPolicy>());
+    nativeFlushPolicy.ref.mode = flushPolicy.mode.index;
+    nativeFlushPolicy.ref.max_pending_items = flushPolicy.maxPendingItems;
+    nativeFlushPolicy.ref.max_pending_bytes = flushPolicy.maxPendingBytes;
+  }
+  Pointer<Void> mercuryIsolate = _allocateNewMercuryIsolate(dartContext.pointer, targetContextId, nativeFlushPolicy);
+  if (nativeFlushPolicy != nullptr) {
+    malloc.free(nativeFlushPolicy);
+  }
   assert(!_allocatedMercuryIsolates.containsKey(targetContextId));
   _allocatedMercuryIsolates[targetContextId] = mercuryIsolate;
 }
@@ -307,6 +341,7 @@ enum IsolateCommandType {
   disposeBindingObject,
   addEvent,
   removeEvent,
+  updateEventListenerSummary,
 }
 
 class IsolateCommandItem extends Struct {
@@ -324,11 +359,18 @@ class IsolateCommandItem extends Struct {
   external Pointer nativePtr;
 }
 
-typedef NativeGetIsolateCommandItems = Pointer<Uint64> Function(Pointer<Void>);
-typedef DartGetIsolateCommandItems = Pointer<Uint64> Function(Pointer<Void>);
+typedef NativeGetIsolateCommandStream = Pointer<Uint8> Function(Pointer<Void>);
+typedef DartGetIsolateCommandStream = Pointer<Uint8> Function(Pointer<Void>);
+
+final DartGetIsolateCommandStream _getIsolateCommandStream =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeGetIsolateCommandStream>>('getIsolateCommandStream').asFunction();
+
+typedef NativeGetIsolateCommandStreamLength = Int64 Function(Pointer<Void>);
+typedef DartGetIsolateCommandStreamLength = int Function(Pointer<Void>);
 
-final DartGetIsolateCommandItems _getIsolateCommandItems =
-    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeGetIsolateCommandItems>>('getIsolateCommandItems').asFunction();
+final DartGetIsolateCommandStreamLength _getIsolateCommandStreamLength = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeGetIsolateCommandStreamLength>>('getIsolateCommandStreamLength')
+    .asFunction();
 
 typedef NativeGetIsolateCommandItemSize = Int64 Function(Pointer<Void>);
 typedef DartGetIsolateCommandItemSize = int Function(Pointer<Void>);
@@ -336,12 +378,197 @@ typedef DartGetIsolateCommandItemSize = int Function(Pointer<Void>);
 final DartGetIsolateCommandItemSize _getIsolateCommandItemSize =
     MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeGetIsolateCommandItemSize>>('getIsolateCommandItemSize').asFunction();
 
+typedef NativeGetIsolateCommandTelemetry = Pointer<NativeIsolateCommandTelemetry> Function(Pointer<Void>);
+typedef DartGetIsolateCommandTelemetry = Pointer<NativeIsolateCommandTelemetry> Function(Pointer<Void>);
+
+final DartGetIsolateCommandTelemetry _getIsolateCommandTelemetry = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeGetIsolateCommandTelemetry>>('getIsolateCommandTelemetry')
+    .asFunction();
+
+// Statistics of the isolate commands sent from the native side, the values are always up to date.
+class IsolateCommandTelemetry {
+  final Pointer<NativeIsolateCommandTelemetry> _nativeTelemetry;
+
+  IsolateCommandTelemetry(Pointer<NativeIsolateCommandTelemetry> telemetry) : _nativeTelemetry = telemetry;
+
+  Map<IsolateCommandType, int> get commandCounts {
+    Map<IsolateCommandType, int> result = {};
+    for (IsolateCommandType type in IsolateCommandType.values) {
+      result[type] = _nativeTelemetry.ref.command_counts[type.index];
+    }
+    return result;
+  }
+
+  int get flushCount => _nativeTelemetry.ref.flush_count;
+  int get totalBytes => _nativeTelemetry.ref.total_bytes;
+  int get lastFlushBytes => _nativeTelemetry.ref.last_flush_bytes;
+  int get maxFlushBytes => _nativeTelemetry.ref.max_flush_bytes;
+  int get maxBufferSize => _nativeTelemetry.ref.max_buffer_size;
+  double get flushesPerSecond => _nativeTelemetry.ref.flushes_per_second;
+
+  // Count of flushes within the latency buckets of 50us, 100us, 250us, 500us, 1ms, 2.5ms, 5ms and longer.
+  List<int> get latencyHistogram {
+    return List.generate(isolateCommandLatencyBucketCount, (int i) => _nativeTelemetry.ref.latency_histogram[i],
+        growable: false);
+  }
+}
+
+IsolateCommandTelemetry getIsolateCommandTelemetry(int contextId) {
+  assert(_allocatedMercuryIsolates.containsKey(contextId));
+  return IsolateCommandTelemetry(_getIsolateCommandTelemetry(_allocatedMercuryIsolates[contextId]!));
+}
+
 typedef NativeClearIsolateCommandItems = Void Function(Pointer<Void>);
 typedef DartClearIsolateCommandItems = void Function(Pointer<Void>);
 
 final DartClearIsolateCommandItems _clearIsolateCommandItems =
     MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeClearIsolateCommandItems>>('clearIsolateCommandItems').asFunction();
 
+typedef NativeSetIsolateCommandCoalescing = Void Function(Pointer<Void>, Int8);
+typedef DartSetIsolateCommandCoalescing = void Function(Pointer<Void>, int);
+
+final DartSetIsolateCommandCoalescing _setIsolateCommandCoalescing = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeSetIsolateCommandCoalescing>>('setIsolateCommandCoalescing')
+    .asFunction();
+
+typedef NativeGetIsolateCommandElidedCount = Int64 Function(Pointer<Void>);
+typedef DartGetIsolateCommandElidedCount = int Function(Pointer<Void>);
+
+final DartGetIsolateCommandElidedCount _getIsolateCommandElidedCount = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeGetIsolateCommandElidedCount>>('getIsolateCommandElidedCount')
+    .asFunction();
+
+// Commands which cancel each other out within one flush are dropped by the native side by default.
+void setIsolateCommandCoalescing(int contextId, bool enabled) {
+  assert(_allocatedMercuryIsolates.containsKey(contextId));
+  _setIsolateCommandCoalescing(_allocatedMercuryIsolates[contextId]!, enabled ? 1 : 0);
+}
+
+// The total count of commands dropped by coalescing.
+int getIsolateCommandElidedCount(int contextId) {
+  assert(_allocatedMercuryIsolates.containsKey(contextId));
+  return _getIsolateCommandElidedCount(_allocatedMercuryIsolates[contextId]!);
+}
+
+typedef NativeResolveAsyncBindingCompletions = Void Function(
+    Pointer<Void>, Pointer<NativeBindingAsyncCompletion>, Int32);
+typedef DartResolveAsyncBindingCompletions = void Function(Pointer<Void>, Pointer<NativeBindingAsyncCompletion>, int);
+
+final DartResolveAsyncBindingCompletions _resolveAsyncBindingCompletions = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeResolveAsyncBindingCompletions>>('resolveAsyncBindingCompletions')
+    .asFunction();
+
+typedef NativeDispatchEvents = Void Function(
+    Pointer<Void>, Pointer<NativeEventDispatch>, Int32, Pointer<EventDispatchResult>);
+typedef DartDispatchEvents = void Function(Pointer<Void>, Pointer<NativeEventDispatch>, int, Pointer<EventDispatchResult>);
+
+final DartDispatchEvents _dispatchEvents =
+    MercuryDynamicLibrary.ref.lookup<NativeFunction<NativeDispatchEvents>>('dispatchEvents').asFunction();
+
+// Dispatch a group of events to the listeners registered at the native side with one call, instead of one call per
+// event. Each event is fired at its currentTarget only, which suits high frequency sources such as sensors, sockets and
+// stream chunks. Unlike single dispatch, JS side props set on these events are not carried back to dart.
+// With [recycleEvents], the native side reuses the JS event objects which listeners did not keep.
+void dispatchEventsToNative(int contextId, List<Event> events, {bool isCapture = false, bool recycleEvents = false}) {
+  if (events.isEmpty || !_allocatedMercuryIsolates.containsKey(contextId)) return;
+  // Keep the order with the passive dispatches deferred by single dispatch.
+  drainPendingEventDispatches();
+
+  int count = events.length;
+  Pointer<NativeEventDispatch> dispatches = malloc.allocate(sizeOf<NativeEventDispatch>() * count);
+  Pointer<EventDispatchResult> results = malloc.allocate(sizeOf<EventDispatchResult>() * count);
+  // Events of the same type share one native string, so the native side builds the type atom once.
+  Map<String, Pointer<NativeString>> types = {};
+  for (int i = 0; i < count; i++) {
+    Event event = events[i];
+    NativeEventDispatch entry = dispatches.elementAt(i).ref;
+    entry.target = event.currentTarget?.pointer ?? nullptr;
+    entry.type = types.putIfAbsent(event.type, () => stringToNativeString(event.type));
+    entry.rawEvent = event.toRaw().cast<RawEvent>();
+    entry.isCapture = isCapture ? 1 : 0;
+    entry.recycle = recycleEvents ? 1 : 0;
+  }
+
+  _dispatchEvents(_allocatedMercuryIsolates[contextId]!, dispatches, count, results);
+
+  for (int i = 0; i < count; i++) {
+    Event event = events[i];
+    EventDispatchResult result = results.elementAt(i).ref;
+    event.cancelable = result.canceled;
+    event.propagationStopped = result.propagationStopped;
+    malloc.free(dispatches.elementAt(i).ref.rawEvent);
+  }
+  types.values.forEach(freeNativeString);
+  malloc.free(results);
+  malloc.free(dispatches);
+}
+
+typedef NativeReleaseNativeTypedArray = Void Function(Pointer<Void>, Int64);
+typedef DartReleaseNativeTypedArray = void Function(Pointer<Void>, int);
+
+final DartReleaseNativeTypedArray _releaseNativeTypedArray = MercuryDynamicLibrary.ref
+    .lookup<NativeFunction<NativeReleaseNativeTypedArray>>('releaseNativeTypedArray')
+    .asFunction();
+
+// Drop the retained JS buffer of a typed array shared by the native side, or its bytes once the context is disposed.
+void releaseNativeTypedArray(int id) {
+  _releaseNativeTypedArray(dartContext.pointer, id);
+}
+
+class AsyncBindingCompletion {
+  final Pointer<Void> promiseContext;
+  final BindingObject owner;
+  final dynamic result;
+  final String? error;
+
+  AsyncBindingCompletion.resolved(this.promiseContext, this.owner, this.result) : error = null;
+  AsyncBindingCompletion.rejected(this.promiseContext, this.owner, String this.error) : result = null;
+}
+
+final Map<int, List<AsyncBindingCompletion>> _pendingAsyncBindingCompletions = {};
+
+// Async binding calls settled within the same turn are handed over to the native side with one call, which resolves
+// all the promises and then runs the promise jobs once.
+void queueAsyncBindingCompletion(int contextId, AsyncBindingCompletion completion) {
+  List<AsyncBindingCompletion>? pending = _pendingAsyncBindingCompletions[contextId];
+  if (pending == null) {
+    pending = _pendingAsyncBindingCompletions[contextId] = [];
+    scheduleMicrotask(() => _flushAsyncBindingCompletions(contextId));
+  }
+  pending.add(completion);
+}
+
+void _flushAsyncBindingCompletions(int contextId) {
+  List<AsyncBindingCompletion>? pending = _pendingAsyncBindingCompletions.remove(contextId);
+  if (pending == null || !_allocatedMercuryIsolates.containsKey(contextId)) return;
+
+  int count = pending.length;
+  Pointer<NativeBindingAsyncCompletion> completions = malloc.allocate(sizeOf<NativeBindingAsyncCompletion>() * count);
+  Pointer<NativeValue> values = malloc.allocate(sizeOf<NativeValue>() * count);
+  for (int i = 0; i < count; i++) {
+    AsyncBindingCompletion completion = pending[i];
+    NativeBindingAsyncCompletion entry = completions.elementAt(i).ref;
+    entry.promiseContext = completion.promiseContext;
+    if (completion.error != null) {
+      entry.value = nullptr;
+      entry.errmsg = completion.error!.toNativeUtf8();
+    } else {
+      toNativeValue(values.elementAt(i), completion.result, completion.owner);
+      entry.value = values.elementAt(i);
+      entry.errmsg = nullptr;
+    }
+  }
+
+  _resolveAsyncBindingCompletions(_allocatedMercuryIsolates[contextId]!, completions, count);
+
+  for (int i = 0; i < count; i++) {
+    Pointer<Utf8> errmsg = completions.elementAt(i).ref.errmsg;
+    if (errmsg != nullptr) malloc.free(errmsg);
+  }
+  malloc.free(values);
+  malloc.free(completions);
+}
+
 class IsolateCommand {
   late final IsolateCommandType type;
   late final String args;
@@ -354,64 +581,24 @@ class IsolateCommand {
   }
 }
 
-// struct IsolateCommandItem {
-//   int32_t type;             // offset: 0 ~ 0.5
-//   int32_t args_01_length;   // offset: 0.5 ~ 1
-//   const uint16_t *string_01;// offset: 1
-//   void* nativePtr;          // offset: 2
-//   void* nativePtr2;         // offset: 3
-// };
-const int nativeCommandSize = 4;
-const int typeAndArgs01LenMemOffset = 0;
-const int args01StringMemOffset = 1;
-const int nativePtrMemOffset = 2;
-const int native2PtrMemOffset = 3;
-
 // We found there are performance bottleneck of reading native memory with Dart FFI API.
-// So we align all Isolate instructions to a whole block of memory, and then convert them into a dart array at one time,
-// To ensure the fastest subsequent random access.
-List<IsolateCommand> readNativeIsolateCommandToDart(Pointer<Uint64> nativeCommandItems, int commandLength, int contextId) {
-  List<int> rawMemory =
-      nativeCommandItems.cast<Int64>().asTypedList(commandLength * nativeCommandSize).toList(growable: false);
-  List<IsolateCommand> results = List.generate(commandLength, (int _i) {
-    int i = _i * nativeCommandSize;
-    IsolateCommand command = IsolateCommand();
-
-    int typeArgs01Combine = rawMemory[i + typeAndArgs01LenMemOffset];
-
-    //      int32_t        int32_t
-    // +-------------+-----------------+
-    // |      type     | args_01_length  |
-    // +-------------+-----------------+
-    int args01Length = (typeArgs01Combine >> 32).toSigned(32);
-    int type = (typeArgs01Combine ^ (args01Length << 32)).toSigned(32);
-
-    command.type = IsolateCommandType.values[type];
-
-    int args01StringMemory = rawMemory[i + args01StringMemOffset];
-    if (args01StringMemory != 0) {
-      Pointer<Uint16> args_01 = Pointer.fromAddress(args01StringMemory);
-      command.args = uint16ToString(args_01, args01Length);
-      malloc.free(args_01);
-    } else {
-      command.args = '';
-    }
-
-    int nativePtrValue = rawMemory[i + nativePtrMemOffset];
-    command.nativePtr = nativePtrValue != 0 ? Pointer.fromAddress(rawMemory[i + nativePtrMemOffset]) : nullptr;
-
-    int nativePtr2Value = rawMemory[i + native2PtrMemOffset];
-    command.nativePtr2 = nativePtr2Value != 0 ? Pointer.fromAddress(nativePtr2Value) : nullptr;
+// So the native side encodes all Isolate instructions into a compact stream within a whole block of memory,
+// and then decode them into a dart array at one time.
+List<IsolateCommand> readNativeIsolateCommandToDart(Pointer<Uint8> nativeStream, int streamLength, int contextId) {
+  List<IsolateCommand> results;
+  try {
+    results = IsolateCommandStreamReader(nativeStream, streamLength).readCommands();
+  } finally {
+    // Release the commands and their string payloads, also when the stream is rejected.
+    _clearIsolateCommandItems(_allocatedMercuryIsolates[contextId]!);
+  }
 
-    if (isEnabledLog) {
+  if (isEnabledLog) {
+    for (IsolateCommand command in results) {
       String printMsg = 'nativePtr: ${command.nativePtr} type: ${command.type} args: ${command.args} nativePtr2: ${command.nativePtr2}';
       print(printMsg);
     }
-    return command;
-  }, growable: false);
-
-  // Clear native command.
-  _clearIsolateCommandItems(_allocatedMercuryIsolates[contextId]!);
+  }
 
   return results;
 }
@@ -430,14 +617,15 @@ void flushIsolateCommandWithContextId(int contextId) {
 
 void flushIsolateCommand(MercuryContextController context) {
   assert(_allocatedMercuryIsolates.containsKey(context.contextId));
-  Pointer<Uint64> nativeCommandItems = _getIsolateCommandItems(_allocatedMercuryIsolates[context.contextId]!);
+  Pointer<Uint8> nativeStream = _getIsolateCommandStream(_allocatedMercuryIsolates[context.contextId]!);
+  int streamLength = _getIsolateCommandStreamLength(_allocatedMercuryIsolates[context.contextId]!);
   int commandLength = _getIsolateCommandItemSize(_allocatedMercuryIsolates[context.contextId]!);
 
-  if (commandLength == 0 || nativeCommandItems == nullptr) {
+  if (commandLength == 0 || streamLength == 0 || nativeStream == nullptr) {
     return;
   }
 
-  List<IsolateCommand> commands = readNativeIsolateCommandToDart(nativeCommandItems, commandLength, context.contextId);
+  List<IsolateCommand> commands = readNativeIsolateCommandToDart(nativeStream, streamLength, context.contextId);
 
   // For new isolate commands, we needs to tell engine to update frames.
   for (int i = 0; i < commandLength; i++) {
@@ -448,7 +636,7 @@ void flushIsolateCommand(MercuryContextController context) {
     try {
       switch (commandType) {
         case IsolateCommandType.createGlobal:
-          context.initGlobal(context, nativePtr.cast<NativeBindingObject>());
+          context.initGlobal(context, command.args, nativePtr.cast<NativeBindingObject>());
           break;
         case IsolateCommandType.createEventTarget:
           context.createEventTarget(context, command.args, nativePtr.cast<NativeBindingObject>());
@@ -464,6 +652,9 @@ void flushIsolateCommand(MercuryContextController context) {
           bool isCapture = command.nativePtr2.address == 1;
           context.removeEvent(nativePtr.cast<NativeBindingObject>(), command.args, isCapture: isCapture);
           break;
+        case IsolateCommandType.updateEventListenerSummary:
+          context.updateEventListenerSummary(nativePtr.cast<NativeBindingObject>(), command.args, command.nativePtr2.address);
+          break;
         default:
           break;
       }
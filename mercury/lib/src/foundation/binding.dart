@@ -16,8 +16,10 @@ class BindingContext {
   final int contextId;
   final MercuryContextController context;
   final Pointer<NativeBindingObject> pointer;
+  // The class name the native side created the object with, native keeps synced shapes by it.
+  final String? className;
 
-  const BindingContext(this.context, this.contextId, this.pointer);
+  const BindingContext(this.context, this.contextId, this.pointer, [this.className]);
 }
 
 typedef BindingPropertyGetter = dynamic Function();
@@ -52,12 +54,24 @@ class AsyncBindingObjectMethod extends BindingObjectMethod {
   final AsyncBindingMethodCallback call;
 }
 
+// Member names synced to the native side for one class, the native side addresses members by the index in these lists.
+class _SyncedShape {
+  _SyncedShape(this.properties, this.syncMethods, this.asyncMethods);
+
+  final List<String> properties;
+  final List<String> syncMethods;
+  final List<String> asyncMethods;
+}
+
 abstract class BindingObject<T> extends Iterable<T> {
   static BindingObjectOperation? bind;
   static BindingObjectOperation? unbind;
 
-  // To make sure same kind of WidgetElement only sync once.
-  static final Map<Type, bool> _alreadySyncClasses = {};
+  // To make sure same kind of WidgetElement only sync once. Keyed the same way as on the native side, by the native
+  // class name, objects which don't have one fall back to their dart type.
+  static final Map<String, _SyncedShape> _syncedShapes = {};
+
+  String get _shapeKey => _context?.className ?? runtimeType.toString();
 
   final BindingContext? _context;
 
@@ -72,22 +86,18 @@ abstract class BindingObject<T> extends Iterable<T> {
     initializeProperties(_properties);
     initializeMethods(_methods);
 
-    if (!_alreadySyncClasses.containsKey(runtimeType)) {
-      bool success = _syncPropertiesAndMethodsToNativeSlow();
+    if (!_syncedShapes.containsKey(_shapeKey)) {
+      _SyncedShape shape = _collectShape();
+      bool success = _syncPropertiesAndMethodsToNativeSlow(shape);
       if (success) {
-        _alreadySyncClasses[runtimeType] = true;
+        _syncedShapes[_shapeKey] = shape;
       }
     }
   }
 
-  bool _syncPropertiesAndMethodsToNativeSlow() {
-    assert(pointer != null);
-    if (pointer!.ref.invokeBindingMethodFromDart == nullptr) return false;
-
-    List<String> properties = _properties.keys.toList(growable: false);
+  _SyncedShape _collectShape() {
     List<String> syncMethods = [];
     List<String> asyncMethods = [];
-
     _methods.forEach((key, method) {
       if (method is BindingObjectMethodSync) {
         syncMethods.add(key);
@@ -95,11 +105,17 @@ abstract class BindingObject<T> extends Iterable<T> {
         asyncMethods.add(key);
       }
     });
+    return _SyncedShape(_properties.keys.toList(growable: false), syncMethods, asyncMethods);
+  }
+
+  bool _syncPropertiesAndMethodsToNativeSlow(_SyncedShape shape) {
+    assert(pointer != null);
+    if (pointer!.ref.invokeBindingMethodFromDart == nullptr) return false;
 
     Pointer<NativeValue> arguments = malloc.allocate(sizeOf<NativeValue>() * 3);
-    toNativeValue(arguments.elementAt(0), properties);
-    toNativeValue(arguments.elementAt(1), syncMethods);
-    toNativeValue(arguments.elementAt(2), asyncMethods);
+    toNativeValue(arguments.elementAt(0), shape.properties);
+    toNativeValue(arguments.elementAt(1), shape.syncMethods);
+    toNativeValue(arguments.elementAt(2), shape.asyncMethods);
 
     DartInvokeBindingMethodsFromDart f = pointer!.ref.invokeBindingMethodFromDart.asFunction();
     Pointer<NativeValue> returnValue = malloc.allocate(sizeOf<NativeValue>());
@@ -114,6 +130,23 @@ abstract class BindingObject<T> extends Iterable<T> {
   final SplayTreeMap<String, BindingObjectProperty> _properties = SplayTreeMap();
   final SplayTreeMap<String, BindingObjectMethod> _methods = SplayTreeMap();
 
+  // Native side addresses properties and methods by the index in the lists synced once for the class. An instance
+  // may register other members than the one which was synced, so ids are resolved through the synced names, and
+  // members this instance doesn't have resolve to null instead of another member.
+  late final List<BindingObjectProperty?> _propertiesById = _resolveIds(_syncedShapes[_shapeKey]?.properties, _properties);
+  late final List<BindingObjectMethod?> _syncMethodsById = _resolveIds(_syncedShapes[_shapeKey]?.syncMethods, _methods);
+  late final List<BindingObjectMethod?> _asyncMethodsById = _resolveIds(_syncedShapes[_shapeKey]?.asyncMethods, _methods);
+
+  static List<V?> _resolveIds<V>(List<String>? names, Map<String, V> members) {
+    if (names == null) return <V?>[];
+    return names.map((name) => members[name]).toList(growable: false);
+  }
+
+  BindingObjectProperty? _getProperty(dynamic key) {
+    if (key is int) return key < _propertiesById.length ? _propertiesById[key] : null;
+    return _properties[key];
+  }
+
   @mustCallSuper
   void initializeProperties(Map<String, BindingObjectProperty> properties);
 
@@ -135,8 +168,10 @@ abstract class BindingObject<T> extends Iterable<T> {
 
   // Call a method, eg:
   //   el.getContext('2x');
-  dynamic _invokeBindingMethodSync(String method, List args) {
-    BindingObjectMethod? fn = _methods[method];
+  dynamic _invokeBindingMethodSync(dynamic method, List args) {
+    BindingObjectMethod? fn = method is int
+        ? (method < _syncMethodsById.length ? _syncMethodsById[method] : null)
+        : _methods[method];
     if (fn == null) {
       return;
     }
@@ -151,8 +186,10 @@ abstract class BindingObject<T> extends Iterable<T> {
   @override
   Iterator<T> get iterator => Iterable<T>.empty().iterator;
 
-  dynamic _invokeBindingMethodAsync(String method, List<dynamic> args) {
-    BindingObjectMethod? fn = _methods[method];
+  dynamic _invokeBindingMethodAsync(dynamic method, List<dynamic> args) {
+    BindingObjectMethod? fn = method is int
+        ? (method < _asyncMethodsById.length ? _asyncMethodsById[method] : null)
+        : _methods[method];
     if (fn == null) {
       return;
     }
@@ -161,30 +198,19 @@ abstract class BindingObject<T> extends Iterable<T> {
       int contextId = args[0];
       // Async callback should hold a context to store the current execution environment.
       Pointer<Void> callbackContext = (args[1] as Pointer).cast<Void>();
-      DartAsyncAnonymousFunctionCallback callback =
-          (args[2] as Pointer).cast<NativeFunction<NativeAsyncAnonymousFunctionCallback>>().asFunction();
       List<dynamic> functionArguments = args.sublist(3);
       Future<dynamic> p = fn.call(functionArguments);
+      // Completions are queued and settled at the native side in one batch per turn.
       p.then((result) {
-        Stopwatch? stopwatch;
-        if (isEnabledLog) {
-          stopwatch = Stopwatch()..start();
-        }
-        Pointer<NativeValue> nativeValue = malloc.allocate(sizeOf<NativeValue>());
-        toNativeValue(nativeValue, result, this);
-        callback(callbackContext, nativeValue, contextId, nullptr);
+        queueAsyncBindingCompletion(contextId, AsyncBindingCompletion.resolved(callbackContext, this, result));
         if (isEnabledLog) {
-          print('AsyncAnonymousFunction call resolved callback: $method arguments:[$result] time: ${stopwatch!.elapsedMicroseconds}us');
+          print('AsyncAnonymousFunction call resolved callback: $method arguments:[$result]');
         }
       }).catchError((e, stack) {
         String errorMessage = '$e\n$stack';
-        Stopwatch? stopwatch;
-        if (isEnabledLog) {
-          stopwatch = Stopwatch()..start();
-        }
-        callback(callbackContext, nullptr, contextId, errorMessage.toNativeUtf8());
+        queueAsyncBindingCompletion(contextId, AsyncBindingCompletion.rejected(callbackContext, this, errorMessage));
         if (isEnabledLog) {
-          print('AsyncAnonymousFunction call rejected callback: $method, arguments:[$errorMessage] time: ${stopwatch!.elapsedMicroseconds}us');
+          print('AsyncAnonymousFunction call rejected callback: $method, arguments:[$errorMessage]');
         }
       });
     }
@@ -203,7 +229,7 @@ abstract class BindingObject<T> extends Iterable<T> {
 dynamic getterBindingCall(BindingObject bindingObject, List<dynamic> args) {
   assert(args.length == 1);
 
-  BindingObjectProperty? property = bindingObject._properties[args[0]];
+  BindingObjectProperty? property = bindingObject._getProperty(args[0]);
 
   Stopwatch? stopwatch;
   if (isEnabledLog && property != null) {
@@ -226,9 +252,8 @@ dynamic setterBindingCall(BindingObject bindingObject, List<dynamic> args) {
     print('$bindingObject setBindingProperty key: ${args[0]} value: ${args[1]}');
   }
 
-  String key = args[0];
   dynamic value = args[1];
-  BindingObjectProperty? property = bindingObject._properties[key];
+  BindingObjectProperty? property = bindingObject._getProperty(args[0]);
   if (property != null && property.setter != null) {
     property.setter!(value);
   }
@@ -271,10 +296,14 @@ dynamic invokeBindingMethodAsync(BindingObject bindingObject, List<dynamic> args
 void invokeBindingMethodFromNativeImpl(int contextId, Pointer<NativeBindingObject> nativeBindingObject,
     Pointer<NativeValue> returnValue, Pointer<NativeValue> nativeMethod, int argc, Pointer<NativeValue> argv) {
   MercuryController controller = MercuryController.getControllerOfJSContextId(contextId)!;
-  dynamic method = fromNativeValue(controller.context, nativeMethod);
+  // Method names are owned by the C++ side.
+  dynamic method = fromNativeValue(controller.context, nativeMethod, borrowed: true);
+  // Arguments of anonymous function calls are allocated in an arena owned by the C++ side.
+  bool borrowed = method == BindingMethodCallOperations.AnonymousFunctionCall.index ||
+      method == BindingMethodCallOperations.AsyncAnonymousFunction.index;
   List<dynamic> values = List.generate(argc, (i) {
     Pointer<NativeValue> nativeValue = argv.elementAt(i);
-    return fromNativeValue(controller.context, nativeValue);
+    return fromNativeValue(controller.context, nativeValue, borrowed: borrowed);
   });
 
   BindingObject bindingObject = controller.context.getBindingObject(nativeBindingObject);
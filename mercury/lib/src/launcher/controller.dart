@@ -159,8 +159,8 @@ class MercuryContextController {
 
   late Global global;
 
-  void initGlobal(MercuryContextController context, Pointer<NativeBindingObject> pointer) {
-    global = Global(BindingContext(context, _contextId, pointer));
+  void initGlobal(MercuryContextController context, String className, Pointer<NativeBindingObject> pointer) {
+    global = Global(BindingContext(context, _contextId, pointer, className));
   }
 
   void evaluateJavaScripts(String code) async {
@@ -200,6 +200,14 @@ class MercuryContextController {
     }
   }
 
+  void updateEventListenerSummary(Pointer<NativeBindingObject> nativePtr, String eventType, int packedSummary) {
+    if (!hasBindingObject(nativePtr)) return;
+    EventTarget? target = getBindingObject<EventTarget>(nativePtr);
+    if (target != null) {
+      BindingBridge.updateListenerSummary(target, eventType, NativeEventListenerSummary.fromPacked(packedSummary));
+    }
+  }
+
   // Call from JS Bridge when the BindingObject class on the JS side had been Garbage collected.
   void disposeBindingObject(MercuryContextController context, Pointer<NativeBindingObject> pointer) async {
     BindingObject? bindingObject = getBindingObject(pointer);
@@ -221,7 +229,7 @@ class MercuryContextController {
 
   void createEventTarget(MercuryContextController context, String className, Pointer<NativeBindingObject> pointer) {
     if (_eventTargetCreator.containsKey(className)) {
-      final target = _eventTargetCreator[className]!(BindingContext(context, _contextId, pointer));
+      final target = _eventTargetCreator[className]!(BindingContext(context, _contextId, pointer, className));
 
       switch (className) {
         case 'MercuryDispatcher': dispatcher = target as MercuryDispatcher;
@@ -257,6 +265,9 @@ class MercuryController {
 
   UriParser? uriParser;
 
+  // Decides when the isolate commands of this controller are flushed, selected once at the creation of the isolate.
+  final IsolateCommandFlushPolicy? isolateCommandFlushPolicy;
+
   static MercuryController? getControllerOfJSContextId(int? contextId) {
     if (!_controllerMap.containsKey(contextId)) {
       return null;
@@ -324,6 +335,7 @@ class MercuryController {
     this.httpClientInterceptor,
     this.devToolsService,
     this.uriParser,
+    this.isolateCommandFlushPolicy,
   })  : _name = name,
         _entrypoint = entrypoint {
 